@@ -5,13 +5,143 @@
 // User-defined API plugin numbers start at 1,000,000.
 static const int IRODS_APN_GENQUERY2 = 1'000'001;
 
+// The API plugin number of the batch variant. See genquery2_batch_input.
+static const int IRODS_APN_GENQUERY2_BATCH = 1'000'002;
+
+// Returned when a query is rejected because the database estimates it to be more expensive
+// than the administrator allows. See the admission_control setting of the API plugin.
+static const int GENQUERY2_QUERY_COST_EXCEEDED = -2'100'000;
+
+// Returned when the database does not finish executing a query before the statement timeout
+// of the request. See genquery2_input::timeout_in_seconds.
+static const int GENQUERY2_STATEMENT_TIMEOUT = -2'101'000;
+
+// Returned when the rows of a query do not fit in the maximum response size of the server
+// and the request did not ask for a truncated result. See genquery2_input::max_response_bytes.
+static const int GENQUERY2_RESPONSE_TOO_LARGE = -2'102'000;
+
+// The values accepted by genquery2_input::output_format.
+static const int GENQUERY2_OUTPUT_FORMAT_JSON = 0;
+static const int GENQUERY2_OUTPUT_FORMAT_ARROW = 1;
+
+// The values accepted by genquery2_input::compression.
+static const int GENQUERY2_COMPRESSION_NONE = 0;
+static const int GENQUERY2_COMPRESSION_ZLIB = 1;
+
+// The values accepted by genquery2_input::explain.
+static const int GENQUERY2_EXPLAIN_NONE = 0;
+static const int GENQUERY2_EXPLAIN_PLAN = 1;
+static const int GENQUERY2_EXPLAIN_ANALYZE = 2;
+
+// The input of the API.
+//
+// The members are transmitted as listed in GenQuery2_Input_PI. The packing instruction lists
+// every member, so it changes whenever a member is added. A peer cannot unpack a request
+// packed according to a different packing instruction. Clients and servers, including the
+// servers of federated zones, must therefore run the same version of the API plugin.
 typedef struct genquery2_input
 {
 	char* query_string;
 	char* zone;
 	int sql_only;
+
+	// A positive value opens a cursor and returns the first page containing at most this
+	// many rows. Subsequent pages are requested via continuation_token.
+	int page_size;
+
+	// The token returned with the previous page of a cursor. If non-null, the next page is
+	// returned and query_string is ignored.
+	char* continuation_token;
+
+	// Selects the encoding of the rows. See GENQUERY2_OUTPUT_FORMAT_*.
+	//
+	// GENQUERY2_OUTPUT_FORMAT_ARROW produces an Apache Arrow IPC stream. The stream is
+	// base64-encoded because the response is transmitted as a string.
+	int output_format;
+
+	// If non-zero, the rows are returned in an object along with the time spent in each phase
+	// of the request (parsing, SQL generation, prepare, execute, fetch, and serialization),
+	// the number of rows, and the number of bytes produced.
+	int include_metrics;
+
+	// The number of seconds the database may spend on the request before the query is
+	// cancelled. Zero selects the default of the server. The server may enforce a smaller
+	// maximum. For cursors, the timeout applies to each page separately.
+	int timeout_in_seconds;
+
+	// Selects how the response is compressed. See GENQUERY2_COMPRESSION_*.
+	//
+	// A compressed response is the base64 encoding of the compressed form of the response
+	// which would have been returned otherwise. Compression pays off for large results,
+	// which tend to repeat long collection names.
+	int compression;
+
+	// A comma-separated list of zones to execute the query in concurrently, or "*" for every
+	// zone known to the server. If non-null, zone is ignored and the result is a JSON object
+	// of the following form:
+	//
+	//     {"rows": [["tempZone", ...], ["otherZone", ...]], "errors": [{"zone": "...", "error_code": -1}]}
+	//
+	// The first element of each row is the name of the zone it came from. ORDER BY and LIMIT
+	// are applied to the merged rows. Cursors, OFFSET, metrics, and output formats other
+	// than JSON are not supported in this mode.
+	char* zones;
+
+	// If non-zero, the response is the number of rows the query would return (e.g. 42)
+	// instead of the rows. ORDER BY, LIMIT, and OFFSET are ignored. Cannot be combined with
+	// cursors, zones, or output formats other than JSON.
+	int count_only;
+
+	// A positive value limits the size of the rows in the response to roughly this many
+	// bytes. Rows are added to the response until the limit is reached, so the response may
+	// exceed the limit by at most one row. The server may enforce a smaller maximum.
+	//
+	// Without a cursor, the response is a JSON object of the following form:
+	//
+	//     {"rows": [...], "truncated": false}
+	//
+	// "truncated" is true if the query produced more rows than the response holds. With a
+	// cursor, the limit applies to each page and the remaining rows are read via the
+	// continuation token. Cannot be combined with zones or count_only.
+	int max_response_bytes;
+
+	// Selects whether the query is explained rather than executed. See GENQUERY2_EXPLAIN_*.
+	//
+	// GENQUERY2_EXPLAIN_PLAN returns the plan the database would use for the generated SQL,
+	// with the actual bind values. GENQUERY2_EXPLAIN_ANALYZE executes the query and includes
+	// the actual row counts and timings. It is only available to administrators. The result
+	// is a JSON object of the following form:
+	//
+	//     {"sql": "...", "plan": ...}
+	//
+	// "plan" is the JSON plan of the database if it has one, or an array of lines. Cannot be
+	// combined with sql_only, cursors, zones, or output formats other than JSON.
+	int explain;
+
+	// A comma-separated list of catalog tables (e.g. "R_RESC_MAIN,R_USER_MAIN"). If non-null,
+	// the results cached for queries reading any of these tables are discarded and nothing
+	// else is done. query_string is ignored. See the result cache of the API plugin.
+	char* invalidate_tables;
 } genquery2_input_t;
 
-#define GenQuery2_Input_PI "str *query_string; str *zone; int sql_only;"
+#define GenQuery2_Input_PI "str *query_string; str *zone; int sql_only; int page_size; str *continuation_token; int output_format; int include_metrics; int timeout_in_seconds; int compression; str *zones; int count_only; int max_response_bytes; int explain; str *invalidate_tables;"
+
+// The input of the batch variant of the API. All queries are executed in one request using
+// the same database connection, which saves a round trip per query.
+//
+// The result is a JSON array containing one object per query, in the order of query_strings.
+// Each object holds the error code of the query and, on success, its rows:
+//
+//     [{"error_code": 0, "rows": [...]}, {"error_code": -130000}]
+//
+// The failure of one query does not prevent the remaining queries from being executed.
+typedef struct genquery2_batch_input
+{
+	int number_of_queries;
+	char** query_strings;
+	char* zone;
+} genquery2_batch_input_t;
+
+#define GenQuery2_Batch_Input_PI "int number_of_queries; str *query_strings[number_of_queries]; str *zone;"
 
 #endif // IRODS_API_PLUGIN_GENQUERY2_COMMON_H
@@ -0,0 +1,41 @@
+#ifndef IRODS_API_PLUGIN_GENQUERY2_PRIVATE_ADMISSION_CONTROL_HPP
+#define IRODS_API_PLUGIN_GENQUERY2_PRIVATE_ADMISSION_CONTROL_HPP
+
+// This file is for the implementation of the plugin. Symbols declared and/or defined in
+// this header MUST NOT be used outside of the plugin.
+
+#include "irods/plugins/api/private/genquery2_query_plan.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+
+namespace irods::experimental::genquery2
+{
+	// Describes how expensive a query from a particular type of user may be before it is
+	// restricted. A maximum of zero means the corresponding estimate is not checked.
+	struct admission_threshold
+	{
+		double max_estimated_cost = 0;
+		double max_estimated_rows = 0;
+
+		// If non-zero, queries exceeding a maximum are executed with their result limited
+		// to this many rows. Otherwise, they are rejected.
+		std::uint64_t row_limit = 0;
+	}; // struct admission_threshold
+
+	enum class admission_decision
+	{
+		admit,
+		limit,
+		reject
+	}; // enum class admission_decision
+
+	// Reads a threshold from the plugin configuration. Missing properties keep their defaults.
+	auto to_admission_threshold(const nlohmann::json& _config) -> admission_threshold;
+
+	auto decide(const admission_threshold& _threshold, const plan_estimate& _estimate) noexcept
+		-> admission_decision;
+} // namespace irods::experimental::genquery2
+
+#endif // IRODS_API_PLUGIN_GENQUERY2_PRIVATE_ADMISSION_CONTROL_HPP
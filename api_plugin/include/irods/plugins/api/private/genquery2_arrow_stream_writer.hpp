@@ -0,0 +1,74 @@
+#ifndef IRODS_API_PLUGIN_GENQUERY2_PRIVATE_ARROW_STREAM_WRITER_HPP
+#define IRODS_API_PLUGIN_GENQUERY2_PRIVATE_ARROW_STREAM_WRITER_HPP
+
+// This file is for the implementation of the plugin. Symbols declared and/or defined in
+// this header MUST NOT be used outside of the plugin.
+
+#include "irods/plugins/api/private/genquery2_result_column.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace irods::experimental::genquery2
+{
+	// Encodes rows as an Apache Arrow IPC stream. The stream holds a schema message, one
+	// record batch containing every appended row, and the end-of-stream marker.
+	//
+	// String columns are encoded as Utf8, integer columns as Int64, and timestamp columns
+	// as Timestamp(SECOND, "UTC"). Integer and timestamp values which cannot be parsed are
+	// encoded as nulls.
+	class arrow_stream_writer
+	{
+	  public:
+		explicit arrow_stream_writer(std::vector<result_column> _columns);
+
+		// Appends the value of the next column of the current row. The row is complete once
+		// a value has been appended for every column.
+		auto append(std::string_view _value) -> void;
+
+		auto append_null() -> void;
+
+		// Returns the number of complete rows.
+		auto number_of_rows() const noexcept -> std::int64_t;
+
+		// Returns the encoded stream.
+		auto finish() const -> std::string;
+
+	  private:
+		struct column_builder
+		{
+			result_column column;
+
+			// One bit per row. A set bit means the value is not null.
+			std::vector<std::uint8_t> validity;
+
+			// The start of each value within "data". Only used by Utf8 columns.
+			std::vector<std::int32_t> offsets;
+
+			// Little-endian 64-bit integers for Int64 and Timestamp columns, or the
+			// concatenated values for Utf8 columns.
+			std::string data;
+
+			std::int64_t null_count = 0;
+		}; // struct column_builder
+
+		// Records whether the current row's value is valid for the current column and
+		// returns the builder for that column.
+		auto next_column(bool _is_valid) -> column_builder&;
+
+		auto end_column() noexcept -> void;
+
+		auto write_schema_message(std::string& _out) const -> void;
+
+		auto write_record_batch_message(std::string& _out) const -> void;
+
+		std::vector<column_builder> columns_;
+		std::size_t current_column_ = 0;
+		std::int64_t rows_ = 0;
+	}; // class arrow_stream_writer
+} // namespace irods::experimental::genquery2
+
+#endif // IRODS_API_PLUGIN_GENQUERY2_PRIVATE_ARROW_STREAM_WRITER_HPP
@@ -0,0 +1,23 @@
+#ifndef IRODS_API_PLUGIN_GENQUERY2_PRIVATE_BATCH_COMMON_HPP
+#define IRODS_API_PLUGIN_GENQUERY2_PRIVATE_BATCH_COMMON_HPP
+
+// This file is for the implementation of the plugin. Symbols declared and/or defined in
+// this header MUST NOT be used outside of the plugin.
+
+#include <irods/rodsDef.h> // For funcPtr.
+
+#include <functional>
+
+// Forward declarations.
+struct RsComm;
+struct genquery2_batch_input;
+
+// The function signature of the batch API plugin.
+using batch_operation_type = std::function<int(RsComm*, const genquery2_batch_input*, char**)>;
+
+// Defined differently based on whether the client module or server module
+// is being compiled. DO NOT CHANGE THESE DECLARATIONS!
+extern const batch_operation_type batch_op;
+extern funcPtr batch_fn_ptr;
+
+#endif // IRODS_API_PLUGIN_GENQUERY2_PRIVATE_BATCH_COMMON_HPP
@@ -0,0 +1,108 @@
+#ifndef IRODS_API_PLUGIN_GENQUERY2_PRIVATE_BULK_RESULT_HPP
+#define IRODS_API_PLUGIN_GENQUERY2_PRIVATE_BULK_RESULT_HPP
+
+// This file is for the implementation of the plugin. Symbols declared and/or defined in
+// this header MUST NOT be used outside of the plugin.
+
+#include "irods/plugins/api/private/genquery2_resource_hierarchy_cache.hpp"
+
+#include <nanodbc/nanodbc.h>
+
+#include <sql.h>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace irods::experimental::genquery2
+{
+	// Executes a prepared statement and fetches its rows in blocks (rowsets) using
+	// column-wise bound buffers. This avoids a round trip through the ODBC driver per row.
+	//
+	// nanodbc::execute cannot be used for this. nanodbc applies its batch size to the
+	// rowset size and to the parameter set size, so a statement with bound parameters
+	// would be executed once per row of the rowset.
+	//
+	// If a column cannot be bound to a fixed size buffer (e.g. text columns), the result
+	// falls back to fetching one row at a time and reading each value via SQLGetData.
+	class bulk_result
+	{
+	  public:
+		// Returns the current resource hierarchies, or null if they cannot be loaded.
+		using resource_hierarchy_loader = std::function<std::shared_ptr<const resource_hierarchy_snapshot>()>;
+
+		// Executes _statement. _statement must be prepared and have its parameters bound.
+		// It must outlive this object.
+		bulk_result(nanodbc::statement& _statement, std::size_t _batch_size);
+
+		// The driver holds pointers to the members of this object.
+		bulk_result(const bulk_result&) = delete;
+		auto operator=(const bulk_result&) -> bulk_result& = delete;
+
+		~bulk_result() = default;
+
+		auto columns() const noexcept -> short;
+
+		// Returns the number of rows fetched per call into the driver. This may be smaller
+		// than the requested batch size.
+		auto batch_size() const noexcept -> std::size_t;
+
+		// Moves to the next row. Returns false once all rows have been read.
+		auto next() -> bool;
+
+		auto is_null(short _column) const -> bool;
+
+		// Copies the value of _column in the current row into _value, or _fallback if the
+		// value is null. Reusing _value across calls avoids allocating for each value.
+		auto get_ref(short _column, const std::string& _fallback, std::string& _value) -> void;
+
+		// Causes get_ref to return the hierarchy of the resource whose ID is stored in each of
+		// _columns. The first time a resource is missing from _snapshot (e.g. it was created
+		// after the snapshot was loaded), the snapshot is marked stale and replaced with the
+		// one returned by _reload. The IDs of resources missing from that snapshot as well no
+		// longer exist and are read as the fallback value.
+		auto resolve_resource_hierarchies(std::vector<std::size_t> _columns,
+		                                  std::shared_ptr<const resource_hierarchy_snapshot> _snapshot,
+		                                  resource_hierarchy_loader _reload) -> void;
+
+	  private:
+		struct bound_column
+		{
+			// The size of each value's slot in "data", including the null terminator.
+			std::size_t width = 0;
+			std::vector<char> data;
+			std::vector<SQLLEN> indicators;
+		}; // struct bound_column
+
+		auto bind_columns(std::size_t _requested_batch_size) -> void;
+
+		auto read_unbound_values() -> void;
+
+		auto read_value(short _column, const std::string& _fallback, std::string& _value) const -> void;
+
+		SQLHSTMT handle_;
+		short n_cols_ = 0;
+		std::size_t batch_size_ = 1;
+
+		// Only used when the columns are bound.
+		std::vector<bound_column> bound_columns_;
+		SQLULEN rows_fetched_ = 0;
+		std::size_t current_row_ = 0;
+
+		// Only used when the columns are not bound. Holds the values of the current row.
+		std::vector<std::optional<std::string>> unbound_values_;
+
+		bool end_of_data_ = false;
+
+		std::vector<std::size_t> resource_hierarchy_columns_;
+		std::shared_ptr<const resource_hierarchy_snapshot> resource_hierarchies_;
+
+		// Empty once the hierarchies were reloaded.
+		resource_hierarchy_loader reload_resource_hierarchies_;
+	}; // class bulk_result
+} // namespace irods::experimental::genquery2
+
+#endif // IRODS_API_PLUGIN_GENQUERY2_PRIVATE_BULK_RESULT_HPP
@@ -0,0 +1,16 @@
+#ifndef IRODS_API_PLUGIN_GENQUERY2_PRIVATE_COMPRESSION_HPP
+#define IRODS_API_PLUGIN_GENQUERY2_PRIVATE_COMPRESSION_HPP
+
+// This file is for the implementation of the plugin. Symbols declared and/or defined in
+// this header MUST NOT be used outside of the plugin.
+
+#include <string>
+#include <string_view>
+
+namespace irods::experimental::genquery2
+{
+	// Returns _bytes compressed as a zlib stream (RFC 1950). Throws on failure.
+	auto compress(std::string_view _bytes) -> std::string;
+} // namespace irods::experimental::genquery2
+
+#endif // IRODS_API_PLUGIN_GENQUERY2_PRIVATE_COMPRESSION_HPP
@@ -0,0 +1,113 @@
+#ifndef IRODS_API_PLUGIN_GENQUERY2_PRIVATE_CONNECTION_POOL_HPP
+#define IRODS_API_PLUGIN_GENQUERY2_PRIVATE_CONNECTION_POOL_HPP
+
+// This file is for the implementation of the plugin. Symbols declared and/or defined in
+// this header MUST NOT be used outside of the plugin.
+
+#include <nanodbc/nanodbc.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace irods::experimental::genquery2
+{
+	struct connection_pool_options
+	{
+		// The maximum number of idle connections kept by the pool. Connections released
+		// while the pool is full are closed. Setting this to zero disables pooling.
+		std::size_t max_size = 2;
+
+		// Idle connections older than this are closed instead of being reused.
+		std::chrono::seconds idle_timeout{300};
+
+		// Idle connections older than this are verified with the health check query
+		// before being handed out.
+		std::chrono::seconds health_check_interval{30};
+
+		// The SQL used to verify that a connection is still usable.
+		std::string health_check_query = "select 1";
+	}; // struct connection_pool_options
+
+	struct connection_pool_statistics
+	{
+		std::uint64_t connections_created = 0;
+		std::uint64_t connections_reused = 0;
+		std::uint64_t connections_discarded = 0;
+		std::size_t idle_connections = 0;
+	}; // struct connection_pool_statistics
+
+	// Keeps database connections open between GenQuery2 requests so that an agent pays the
+	// connection handshake once rather than once per request.
+	class connection_pool
+	{
+	  public:
+		using connection_factory = std::function<nanodbc::connection()>;
+		using clock_type = std::chrono::steady_clock;
+
+		// Returns its connection to the pool on destruction.
+		//
+		// If the lease is destroyed while an exception is propagating, the connection is
+		// assumed to be in an unknown state and is closed rather than returned.
+		class connection_lease
+		{
+		  public:
+			connection_lease(connection_pool& _pool, nanodbc::connection _conn);
+
+			connection_lease(const connection_lease&) = delete;
+			auto operator=(const connection_lease&) -> connection_lease& = delete;
+
+			connection_lease(connection_lease&& _other) noexcept;
+			auto operator=(connection_lease&&) -> connection_lease& = delete;
+
+			~connection_lease();
+
+			auto get() noexcept -> nanodbc::connection&;
+
+		  private:
+			connection_pool* pool_;
+			nanodbc::connection conn_;
+			int uncaught_exceptions_;
+		}; // class connection_lease
+
+		connection_pool(connection_factory _factory, connection_pool_options _options);
+
+		connection_pool(const connection_pool&) = delete;
+		auto operator=(const connection_pool&) -> connection_pool& = delete;
+
+		// Returns a healthy idle connection if one exists. Otherwise, a new connection is
+		// created using the connection factory.
+		auto acquire() -> connection_lease;
+
+		auto statistics() const -> connection_pool_statistics;
+
+	  private:
+		struct idle_connection
+		{
+			nanodbc::connection conn;
+			clock_type::time_point last_used;
+		}; // struct idle_connection
+
+		auto release(nanodbc::connection _conn, bool _healthy) -> void;
+
+		auto is_healthy(idle_connection& _ic, clock_type::time_point _now) -> bool;
+
+		connection_factory factory_;
+		connection_pool_options options_;
+
+		mutable std::mutex mutex_;
+
+		// The most recently used connection is always at the back.
+		std::vector<idle_connection> idle_;
+
+		std::uint64_t connections_created_ = 0;
+		std::uint64_t connections_reused_ = 0;
+		std::uint64_t connections_discarded_ = 0;
+	}; // class connection_pool
+} // namespace irods::experimental::genquery2
+
+#endif // IRODS_API_PLUGIN_GENQUERY2_PRIVATE_CONNECTION_POOL_HPP
@@ -0,0 +1,101 @@
+#ifndef IRODS_API_PLUGIN_GENQUERY2_PRIVATE_CURSOR_TABLE_HPP
+#define IRODS_API_PLUGIN_GENQUERY2_PRIVATE_CURSOR_TABLE_HPP
+
+// This file is for the implementation of the plugin. Symbols declared and/or defined in
+// this header MUST NOT be used outside of the plugin.
+
+#include "irods/plugins/api/private/genquery2_bulk_result.hpp"
+#include "irods/plugins/api/private/genquery2_connection_pool.hpp"
+#include "irods/plugins/api/private/genquery2_translation_cache.hpp"
+
+#include <nanodbc/nanodbc.h>
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace irods::experimental::genquery2
+{
+	// An open result set which is read one page at a time across multiple requests.
+	struct cursor
+	{
+		using clock_type = std::chrono::steady_clock;
+
+		explicit cursor(connection_pool::connection_lease _conn)
+			: conn{std::move(_conn)}
+			, statement{conn.get()}
+		{
+		}
+
+		// The connection must outlive the statement and result. Do not reorder these members.
+		connection_pool::connection_lease conn;
+		nanodbc::statement statement;
+		std::optional<bulk_result> result;
+
+		// The query read by the cursor. The statement refers to the bound values of the
+		// translation, so it must live as long as the statement. The columns are required by
+		// the Arrow output format. Pages which take too long are logged as slow queries.
+		std::string query_string;
+		translation query;
+
+		// The user who opened the cursor. Only this user is allowed to read from it.
+		std::string username;
+
+		// The number of rows returned per page unless the request asks for a different amount.
+		std::size_t page_size = 0;
+
+		// The size limit of the rows of each page unless the request asks for a different limit.
+		std::size_t max_page_bytes = 0;
+
+		// The encoding of each page. See GENQUERY2_OUTPUT_FORMAT_*.
+		int output_format = 0;
+
+		// True if the result is positioned on a row which has not been returned to the client yet.
+		// This happens because the only way to know if more rows exist is to fetch the next one.
+		bool has_pending_row = false;
+
+		clock_type::time_point last_used = clock_type::now();
+	}; // struct cursor
+
+	// Maps continuation tokens to open cursors for a single agent.
+	class cursor_table
+	{
+	  public:
+		cursor_table(std::size_t _max_size, std::chrono::seconds _idle_timeout);
+
+		cursor_table(const cursor_table&) = delete;
+		auto operator=(const cursor_table&) -> cursor_table& = delete;
+
+		// Returns true if no more cursors can be opened.
+		auto full() const noexcept -> bool;
+
+		// Takes ownership of _cursor and returns the continuation token which identifies it.
+		auto insert(std::unique_ptr<cursor> _cursor) -> std::string;
+
+		// Returns the cursor identified by _token, or nullptr if it does not exist.
+		auto find(const std::string& _token) -> cursor*;
+
+		auto erase(const std::string& _token) -> void;
+
+		// Closes all cursors which have been idle longer than the idle timeout. Returns the
+		// number of cursors closed.
+		auto erase_expired() -> std::size_t;
+
+	  private:
+		auto generate_token() -> std::string;
+
+		std::size_t max_size_;
+		std::chrono::seconds idle_timeout_;
+		std::mt19937_64 rng_;
+		std::map<std::string, std::unique_ptr<cursor>, std::less<>> cursors_;
+	}; // class cursor_table
+} // namespace irods::experimental::genquery2
+
+#endif // IRODS_API_PLUGIN_GENQUERY2_PRIVATE_CURSOR_TABLE_HPP
@@ -0,0 +1,57 @@
+#ifndef IRODS_API_PLUGIN_GENQUERY2_PRIVATE_JSON_STREAM_WRITER_HPP
+#define IRODS_API_PLUGIN_GENQUERY2_PRIVATE_JSON_STREAM_WRITER_HPP
+
+// This file is for the implementation of the plugin. Symbols declared and/or defined in
+// this header MUST NOT be used outside of the plugin.
+
+#include <cstddef>
+#include <string_view>
+
+namespace irods::experimental::genquery2
+{
+	// Builds a JSON document in a single buffer allocated with malloc. The buffer can be
+	// handed to the API output, which is freed by the server using free, without copying it.
+	//
+	// The writer does not track the structure of the document. Callers are responsible for
+	// writing brackets and separators via raw.
+	class json_stream_writer
+	{
+	  public:
+		explicit json_stream_writer(std::size_t _initial_capacity = 4096);
+
+		json_stream_writer(const json_stream_writer&) = delete;
+		auto operator=(const json_stream_writer&) -> json_stream_writer& = delete;
+
+		~json_stream_writer();
+
+		// Appends _s without modification.
+		auto raw(std::string_view _s) -> void;
+
+		// Appends _s as a quoted JSON string. Invalid UTF-8 sequences are replaced with U+FFFD.
+		auto string(std::string_view _s) -> void;
+
+		// Returns the number of bytes written so far.
+		auto size() const noexcept -> std::size_t;
+
+		// Discards everything written after the first _size bytes. This allows a caller to
+		// drop a partially written value. _size must not be greater than size().
+		auto truncate(std::size_t _size) noexcept -> void;
+
+		// Null-terminates the document and transfers ownership of the buffer to the caller.
+		// The buffer must be released using free, so API output can be handed to the server as is.
+		// The writer is empty afterwards.
+		auto release() -> char*;
+
+	  private:
+		// Guarantees space for _n more bytes plus a null terminator.
+		auto reserve(std::size_t _n) -> void;
+
+		auto append_escaped(unsigned char _c) -> void;
+
+		char* data_ = nullptr;
+		std::size_t size_ = 0;
+		std::size_t capacity_ = 0;
+	}; // class json_stream_writer
+} // namespace irods::experimental::genquery2
+
+#endif // IRODS_API_PLUGIN_GENQUERY2_PRIVATE_JSON_STREAM_WRITER_HPP
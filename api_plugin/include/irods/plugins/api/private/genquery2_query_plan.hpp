@@ -0,0 +1,61 @@
+#ifndef IRODS_API_PLUGIN_GENQUERY2_PRIVATE_QUERY_PLAN_HPP
+#define IRODS_API_PLUGIN_GENQUERY2_PRIVATE_QUERY_PLAN_HPP
+
+// This file is for the implementation of the plugin. Symbols declared and/or defined in
+// this header MUST NOT be used outside of the plugin.
+
+#include <nanodbc/nanodbc.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace irods::experimental::genquery2
+{
+	// The planner's estimate of the work needed to execute a statement.
+	struct plan_estimate
+	{
+		// The total cost of the statement, in the units of the database. Costs are only
+		// comparable between queries executed against the same database.
+		double cost = 0;
+
+		// The number of rows the statement is expected to produce. Negative if the database
+		// does not report it.
+		double rows = -1;
+	}; // struct plan_estimate
+
+	// Returns the plan the database would use to execute _sql, as reported by the EXPLAIN
+	// facility of the dialect named by _database (postgres, mysql, or oracle). Each row of
+	// the EXPLAIN output becomes one line. Columns are separated by " | ".
+	//
+	// _values are bound to the placeholders in _sql so that the plan matches the one used
+	// for the actual query. Throws if the database rejects the statement.
+	auto explain(nanodbc::connection& _conn,
+	             std::string_view _database,
+	             const std::string& _sql,
+	             const std::vector<std::string>& _values) -> std::string;
+
+	// Returns the plan the database would use to execute _sql as a JSON document. The plan is
+	// the JSON produced by the database if it supports one (postgres and mysql). Otherwise,
+	// the plan is a JSON array holding one string per line of the EXPLAIN output.
+	//
+	// If _analyze is true, _sql is executed and the plan includes the actual number of rows
+	// and the time spent in each step. The rows produced by _sql are discarded. _sql is
+	// executed via _stmt, so it can be cancelled (e.g. by a statement_watchdog).
+	//
+	// Throws if the database rejects the statement.
+	auto explain_json(nanodbc::statement& _stmt,
+	                  std::string_view _database,
+	                  const std::string& _sql,
+	                  const std::vector<std::string>& _values,
+	                  bool _analyze) -> std::string;
+
+	// Returns the planner's estimate for _sql without executing it. Throws if the database
+	// rejects the statement or does not report an estimate.
+	auto estimate(nanodbc::connection& _conn,
+	              std::string_view _database,
+	              const std::string& _sql,
+	              const std::vector<std::string>& _values) -> plan_estimate;
+} // namespace irods::experimental::genquery2
+
+#endif // IRODS_API_PLUGIN_GENQUERY2_PRIVATE_QUERY_PLAN_HPP
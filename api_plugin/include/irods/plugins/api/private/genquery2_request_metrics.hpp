@@ -0,0 +1,124 @@
+#ifndef IRODS_API_PLUGIN_GENQUERY2_PRIVATE_REQUEST_METRICS_HPP
+#define IRODS_API_PLUGIN_GENQUERY2_PRIVATE_REQUEST_METRICS_HPP
+
+// This file is for the implementation of the plugin. Symbols declared and/or defined in
+// this header MUST NOT be used outside of the plugin.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace irods::experimental::genquery2
+{
+	// Describes where the time of a GenQuery2 request was spent.
+	//
+	// Collecting metrics is opt-in. Code paths accept a pointer to an instance and skip all
+	// measurements, including reading the clock, when the pointer is null.
+	struct request_metrics
+	{
+		using clock_type = std::chrono::steady_clock;
+		using duration = clock_type::duration;
+
+		clock_type::time_point start = clock_type::now();
+
+		// Parsing and SQL generation are skipped when the translation cache holds the query.
+		duration parse{};
+		duration to_sql{};
+		duration prepare{};
+		duration execute{};
+
+		// Time spent waiting on the database for rows, as opposed to encoding them.
+		duration fetch{};
+		duration serialize{};
+
+		// Set by finish().
+		duration total{};
+
+		std::size_t rows = 0;
+		std::size_t bytes = 0;
+
+		// The fingerprint of the query. Zero for requests which do not translate a query (e.g.
+		// requests for the next page of a cursor). See translation.
+		std::uint64_t fingerprint = 0;
+
+		// The error code of a failed request. Zero if the request succeeded.
+		int error_code = 0;
+
+		// Records the total duration and the size of the response.
+		auto finish(std::size_t _bytes) -> void;
+	}; // struct request_metrics
+
+	// Adds the time between its construction and destruction to one phase of a request.
+	// Does nothing if the metrics pointer is null.
+	class phase_timer
+	{
+	  public:
+		using phase_type = request_metrics::duration request_metrics::*;
+
+		phase_timer(request_metrics* _metrics, phase_type _phase) noexcept
+			: metrics_{_metrics}
+			, phase_{_phase}
+		{
+			if (metrics_) {
+				start_ = request_metrics::clock_type::now();
+			}
+		} // phase_timer
+
+		phase_timer(const phase_timer&) = delete;
+		auto operator=(const phase_timer&) -> phase_timer& = delete;
+
+		~phase_timer()
+		{
+			if (metrics_) {
+				metrics_->*phase_ += request_metrics::clock_type::now() - start_;
+			}
+		} // ~phase_timer
+
+	  private:
+		request_metrics* metrics_;
+		phase_type phase_;
+		request_metrics::clock_type::time_point start_;
+	}; // class phase_timer
+
+	// Measures the time spent serializing rows. Rows are fetched and serialized in the same
+	// loop, so this is the time between construction and destruction minus the time
+	// recorded for fetching in between. Does nothing if the metrics pointer is null.
+	class serialize_timer
+	{
+	  public:
+		explicit serialize_timer(request_metrics* _metrics) noexcept
+			: metrics_{_metrics}
+		{
+			if (metrics_) {
+				fetch_ = metrics_->fetch;
+				start_ = request_metrics::clock_type::now();
+			}
+		} // serialize_timer
+
+		serialize_timer(const serialize_timer&) = delete;
+		auto operator=(const serialize_timer&) -> serialize_timer& = delete;
+
+		~serialize_timer()
+		{
+			if (metrics_) {
+				const auto elapsed = request_metrics::clock_type::now() - start_;
+				metrics_->serialize += elapsed - (metrics_->fetch - fetch_);
+			}
+		} // ~serialize_timer
+
+	  private:
+		request_metrics* metrics_;
+		request_metrics::duration fetch_{};
+		request_metrics::clock_type::time_point start_;
+	}; // class serialize_timer
+
+	// Returns the metrics as a JSON object. Durations are in microseconds.
+	auto to_json(const request_metrics& _metrics) -> std::string;
+
+	// Writes the metrics as a single structured log record.
+	auto log_request_metrics(const request_metrics& _metrics, std::string_view _query_string) -> void;
+} // namespace irods::experimental::genquery2
+
+#endif // IRODS_API_PLUGIN_GENQUERY2_PRIVATE_REQUEST_METRICS_HPP
@@ -0,0 +1,88 @@
+#ifndef IRODS_API_PLUGIN_GENQUERY2_PRIVATE_RESOURCE_HIERARCHY_CACHE_HPP
+#define IRODS_API_PLUGIN_GENQUERY2_PRIVATE_RESOURCE_HIERARCHY_CACHE_HPP
+
+// This file is for the implementation of the plugin. Symbols declared and/or defined in
+// this header MUST NOT be used outside of the plugin.
+
+#include "irods/genquery2_sql.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace irods::experimental::genquery2
+{
+	// A row of R_RESC_MAIN.
+	struct resource_row
+	{
+		std::string id;
+		std::string name;
+
+		// The ID of the parent resource. Empty for root resources.
+		std::string parent_id;
+	}; // struct resource_row
+
+	// Maps the ID of each resource in _rows to its hierarchy (e.g. "root;pt;leaf").
+	auto build_resource_hierarchies(const std::vector<resource_row>& _rows)
+		-> irods::experimental::api::genquery::resource_hierarchy_map;
+
+	// The resource hierarchies as of the time they were loaded.
+	struct resource_hierarchy_snapshot
+	{
+		// Changes whenever the hierarchies change. Never zero.
+		std::uint64_t version = 0;
+
+		irods::experimental::api::genquery::resource_hierarchy_map hierarchies;
+
+		// Set when a query encounters a resource missing from "hierarchies" (e.g. one created
+		// after the snapshot was loaded). The snapshot is reloaded by the next request.
+		mutable std::atomic<bool> stale{false};
+	}; // struct resource_hierarchy_snapshot
+
+	// Holds the resource hierarchies of the catalog so that queries involving DATA_RESC_HIER do
+	// not rebuild them via a recursive common table expression. See gq::options.
+	//
+	// Resource trees rarely change, so the hierarchies are reloaded periodically rather than
+	// on every query. Changes are picked up sooner if the result cache reports that R_RESC_MAIN
+	// was invalidated.
+	class resource_hierarchy_cache
+	{
+	  public:
+		using loader = std::function<std::vector<resource_row>()>;
+		using clock_type = std::chrono::steady_clock;
+
+		// _load is invoked to read R_RESC_MAIN. Snapshots older than _ttl are reloaded.
+		resource_hierarchy_cache(loader _load, std::chrono::seconds _ttl);
+
+		resource_hierarchy_cache(const resource_hierarchy_cache&) = delete;
+		auto operator=(const resource_hierarchy_cache&) -> resource_hierarchy_cache& = delete;
+
+		// Returns the current snapshot, reloading it if it expired, was marked stale, or
+		// _catalog_generation differs from the one it was loaded with. _catalog_generation is
+		// the generation of R_RESC_MAIN in the result cache, if it is available.
+		//
+		// Throws if the hierarchies cannot be loaded.
+		auto get(std::optional<std::uint64_t> _catalog_generation) -> std::shared_ptr<const resource_hierarchy_snapshot>;
+
+		// Causes the next call to get() to reload the hierarchies.
+		auto invalidate() -> void;
+
+	  private:
+		loader load_;
+		std::chrono::seconds ttl_;
+
+		std::mutex mutex_;
+		std::shared_ptr<resource_hierarchy_snapshot> snapshot_;
+		clock_type::time_point loaded_at_;
+		std::optional<std::uint64_t> catalog_generation_;
+		std::uint64_t last_version_ = 0;
+	}; // class resource_hierarchy_cache
+} // namespace irods::experimental::genquery2
+
+#endif // IRODS_API_PLUGIN_GENQUERY2_PRIVATE_RESOURCE_HIERARCHY_CACHE_HPP
@@ -0,0 +1,88 @@
+#ifndef IRODS_API_PLUGIN_GENQUERY2_PRIVATE_RESULT_CACHE_HPP
+#define IRODS_API_PLUGIN_GENQUERY2_PRIVATE_RESULT_CACHE_HPP
+
+// This file is for the implementation of the plugin. Symbols declared and/or defined in
+// this header MUST NOT be used outside of the plugin.
+
+#include <boost/interprocess/managed_shared_memory.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace irods::experimental::genquery2
+{
+	// The outcome of looking up a result in the result_cache.
+	struct result_cache_lookup
+	{
+		// The cached result, if one exists and is still valid.
+		std::optional<std::string> value;
+
+		// The generation of the tables read by the query at the time of the lookup. Must be
+		// passed to result_cache::insert when the result of the query is stored. Empty if the
+		// cache could not be consulted.
+		std::optional<std::uint64_t> generation;
+	}; // struct result_cache_lookup
+
+	// Returns the names of the catalog tables (e.g. R_DATA_MAIN) referenced by _sql, without
+	// duplicates.
+	auto referenced_tables(std::string_view _sql) -> std::vector<std::string>;
+
+	// A cache of serialized results shared by all agents on the host via a shared memory
+	// segment. Agents are forked per connection, so a cache held by one agent would not
+	// benefit the agents of other clients.
+	//
+	// Entries expire after a fixed amount of time. In addition, each catalog table has a
+	// version. Invalidating a table increments its version, which invalidates the entries of
+	// every query reading that table. The generation of a query is the sum of the versions
+	// of the tables it reads. Versions only increase, so any invalidation changes it.
+	//
+	// All operations are guarded by a mutex within the segment. An agent which cannot acquire
+	// the mutex quickly (e.g. because another agent died while holding it) bypasses the cache
+	// rather than waiting.
+	class result_cache
+	{
+	  public:
+		// Opens the shared memory segment, creating it with a size of _size_in_bytes if it
+		// does not exist. Throws if the segment cannot be opened.
+		result_cache(std::size_t _size_in_bytes, std::chrono::seconds _ttl);
+
+		result_cache(const result_cache&) = delete;
+		auto operator=(const result_cache&) -> result_cache& = delete;
+
+		// Returns the result stored for _key if it has not expired and none of _tables were
+		// invalidated since it was stored.
+		auto find(std::string_view _key, const std::vector<std::string>& _tables) -> result_cache_lookup;
+
+		// Stores _value for _key. _generation must be the generation returned by the lookup
+		// which preceded executing the query. If the tables were invalidated while the query
+		// was executing, the entry is discarded by the next lookup.
+		//
+		// If the segment is full, expired entries are evicted first, then every entry.
+		auto insert(std::string_view _key, std::uint64_t _generation, std::string_view _value) -> void;
+
+		// Returns the generation of _tables, or an empty optional if the mutex could not be
+		// acquired. Lets other caches of catalog data observe invalidations.
+		auto generation(const std::vector<std::string>& _tables) -> std::optional<std::uint64_t>;
+
+		// Increments the version of each table in _tables. Returns false if the mutex could not
+		// be acquired, in which case the cached results remain valid until they expire.
+		auto invalidate(const std::vector<std::string>& _tables) -> bool;
+
+	  private:
+		struct segment_data;
+
+		// Requires the mutex to be held.
+		auto generation_of(const std::vector<std::string>& _tables) const -> std::uint64_t;
+
+		boost::interprocess::managed_shared_memory segment_;
+		segment_data* data_;
+		std::chrono::seconds ttl_;
+	}; // class result_cache
+} // namespace irods::experimental::genquery2
+
+#endif // IRODS_API_PLUGIN_GENQUERY2_PRIVATE_RESULT_CACHE_HPP
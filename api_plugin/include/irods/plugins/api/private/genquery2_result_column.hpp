@@ -0,0 +1,23 @@
+#ifndef IRODS_API_PLUGIN_GENQUERY2_PRIVATE_RESULT_COLUMN_HPP
+#define IRODS_API_PLUGIN_GENQUERY2_PRIVATE_RESULT_COLUMN_HPP
+
+// This file is for the implementation of the plugin. Symbols declared and/or defined in
+// this header MUST NOT be used outside of the plugin.
+
+#include "irods/table_column_key_maps.hpp"
+
+#include <string>
+
+namespace irods::experimental::genquery2
+{
+	// Describes one column of the result set produced by a GenQuery2 string.
+	struct result_column
+	{
+		// The selection as written in the GenQuery2 string (e.g. DATA_SIZE, count(DATA_ID)).
+		std::string name;
+
+		irods::experimental::api::genquery::column_type type = irods::experimental::api::genquery::column_type::string;
+	}; // struct result_column
+} // namespace irods::experimental::genquery2
+
+#endif // IRODS_API_PLUGIN_GENQUERY2_PRIVATE_RESULT_COLUMN_HPP
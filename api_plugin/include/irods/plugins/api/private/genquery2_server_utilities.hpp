@@ -0,0 +1,243 @@
+#ifndef IRODS_API_PLUGIN_GENQUERY2_PRIVATE_SERVER_UTILITIES_HPP
+#define IRODS_API_PLUGIN_GENQUERY2_PRIVATE_SERVER_UTILITIES_HPP
+
+// This file is for the implementation of the plugin. Symbols declared and/or defined in
+// this header MUST NOT be used outside of the plugin.
+
+#include "irods/plugins/api/private/genquery2_admission_control.hpp"
+#include "irods/plugins/api/private/genquery2_arrow_stream_writer.hpp"
+#include "irods/plugins/api/private/genquery2_bulk_result.hpp"
+#include "irods/plugins/api/private/genquery2_connection_pool.hpp"
+#include "irods/plugins/api/private/genquery2_json_stream_writer.hpp"
+#include "irods/plugins/api/private/genquery2_request_metrics.hpp"
+#include "irods/plugins/api/private/genquery2_resource_hierarchy_cache.hpp"
+#include "irods/plugins/api/private/genquery2_result_cache.hpp"
+#include "irods/plugins/api/private/genquery2_translation_cache.hpp"
+
+#include "irods/genquery2_sql.hpp"
+
+#include <nanodbc/nanodbc.h>
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Forward declarations.
+struct RsComm;
+struct rodsServerHost;
+
+// The functions declared here are shared by the server modules of the GenQuery2 API
+// endpoints. Each module holds its own copy of the configuration, caches, and pools.
+namespace irods::experimental::genquery2
+{
+	// Holds the settings which control the behavior of the API plugins on the catalog service
+	// provider. Administrators can override the defaults via the following stanza in
+	// server_config.json:
+	//
+	//     "plugin_configuration": {
+	//         "api": {
+	//             "genquery2": {
+	//                 "translation_cache_size": 256,
+	//                 "connection_pool_size": 2,
+	//                 "connection_idle_timeout_in_seconds": 300,
+	//                 "connection_health_check_interval_in_seconds": 30,
+	//                 "max_open_cursors": 8,
+	//                 "cursor_idle_timeout_in_seconds": 300,
+	//                 "fetch_batch_size": 100,
+	//                 "log_request_metrics": false,
+	//                 "slow_query_threshold_in_milliseconds": 0,
+	//                 "slow_query_log_bind_values": false,
+	//                 "statement_timeout_in_seconds": 0,
+	//                 "max_statement_timeout_in_seconds": 0,
+	//                 "cancel_on_client_disconnect": false,
+	//                 "max_response_bytes": 0,
+	//                 "result_cache_size_in_bytes": 0,
+	//                 "result_cache_ttl_in_seconds": 10,
+	//                 "result_cache_max_entry_bytes": 65536,
+	//                 "resource_hierarchy_cache_ttl_in_seconds": 0,
+	//                 "zones_use_byte_order_collation": false,
+	//                 "admission_control": {
+	//                     "rodsuser": {
+	//                         "max_estimated_cost": 0,
+	//                         "max_estimated_rows": 0,
+	//                         "row_limit": 0
+	//                     }
+	//                 }
+	//             }
+	//         }
+	//     }
+	struct plugin_configuration
+	{
+		// The database type (e.g. postgres, mysql, oracle).
+		std::string database;
+
+		// The maximum number of translated GenQuery2 strings held in memory by each agent.
+		// Setting this to zero disables the translation cache.
+		std::size_t translation_cache_size = 256;
+
+		// Controls how database connections are reused across requests handled by the same agent.
+		connection_pool_options connection_pool;
+
+		// The maximum number of cursors each agent keeps open at once.
+		std::size_t max_open_cursors = 8;
+
+		// Cursors which have not been read from for this long are closed.
+		std::chrono::seconds cursor_idle_timeout{300};
+
+		// The number of rows fetched from the database per call into the ODBC driver. The
+		// batch size is reduced automatically for queries which produce wide rows.
+		std::size_t fetch_batch_size = 100;
+
+		// Writes the metrics of every request to the log. See request_metrics.
+		bool log_request_metrics = false;
+
+		// Requests which take at least this long are logged along with their SQL and query
+		// plan. Zero disables the slow query log.
+		std::chrono::milliseconds slow_query_threshold{0};
+
+		// Bind values may contain sensitive information (e.g. metadata or user names), so the
+		// slow query log omits them unless this is enabled.
+		bool slow_query_log_bind_values = false;
+
+		// The statement timeout of requests which do not specify one. Zero means no timeout.
+		std::chrono::seconds statement_timeout{0};
+
+		// The largest statement timeout a request may ask for. Zero means no maximum.
+		std::chrono::seconds max_statement_timeout{0};
+
+		// Cancels statements whose client disconnects while they are running. Watching the
+		// client requires a thread per statement, so it is disabled by default.
+		bool cancel_on_client_disconnect = false;
+
+		// The largest response, in bytes, the agent builds for a single request or page. Zero
+		// means no maximum.
+		std::size_t max_response_bytes = 0;
+
+		// The size of the shared memory segment holding the results cached for all agents on
+		// the host. Zero disables the result cache.
+		std::size_t result_cache_size_in_bytes = 0;
+
+		// How long a cached result is served before the query is executed again.
+		std::chrono::seconds result_cache_ttl{10};
+
+		// Results larger than this are not cached.
+		std::size_t result_cache_max_entry_bytes = 65536;
+
+		// How long the resource hierarchies used to resolve DATA_RESC_HIER are kept before
+		// they are read from the catalog again. Zero disables the resource hierarchy cache, in
+		// which case the hierarchies are produced by the database for every query. Conditions
+		// on DATA_RESC_HIER may match outdated hierarchies for this long, so the cache must be
+		// enabled explicitly.
+		std::chrono::seconds resource_hierarchy_cache_ttl{0};
+
+		// Set if the catalog of every zone sorts strings byte-wise (i.e. the "C" collation).
+		// Queries across zones may only sort by string columns if this is set.
+		bool zones_use_byte_order_collation = false;
+
+		// Maps a user type (e.g. rodsuser) to the maximum estimated cost of the queries its
+		// users may execute. Queries from user types which are not listed are not checked.
+		std::unordered_map<std::string, admission_threshold> admission_thresholds;
+	}; // struct plugin_configuration
+
+	// The configuration is read once per agent.
+	auto get_plugin_configuration() -> const plugin_configuration&;
+
+	auto get_translation_cache() -> translation_cache&;
+
+	auto get_connection_pool() -> connection_pool&;
+
+	// Returns nullptr if the result cache is disabled or its shared memory segment could not
+	// be opened.
+	auto get_result_cache() -> result_cache*;
+
+	// Returns nullptr if the resource hierarchy cache is disabled.
+	auto get_resource_hierarchy_cache() -> resource_hierarchy_cache*;
+
+	// Writes the statistics of the connection pool to the trace log.
+	auto log_connection_pool_statistics() -> void;
+
+	// Finds the catalog service provider of _zone, connecting to it if it is remote. A null
+	// _zone refers to the local zone.
+	//
+	// Returns 0 on success, or an error code if the zone cannot be reached or does not exist.
+	auto resolve_catalog_provider(RsComm* _comm, const char* _zone, rodsServerHost** _host_info) -> int;
+
+	// Converts a GenQuery2 string into SQL, consulting the translation cache first. If the
+	// string refers to DATA_RESC_HIER, the resource hierarchy cache is consulted as well.
+	// Throws if the string cannot be parsed.
+	//
+	// The functions which accept a request_metrics pointer record their phases in it, if it
+	// is not null.
+	auto translate(std::string_view _query_string,
+	               const irods::experimental::api::genquery::options& _opts,
+	               request_metrics* _metrics) -> translation;
+
+	// Checks the estimated cost of _translation against the admission thresholds of the
+	// client's user type. Queries over the row threshold are retranslated with a row limit
+	// (i.e. _opts and _translation are updated).
+	//
+	// Returns 0 if the query may be executed, or GENQUERY2_QUERY_COST_EXCEEDED if it is
+	// rejected.
+	auto apply_admission_control(RsComm* _comm,
+	                             std::string_view _query_string,
+	                             irods::experimental::api::genquery::options& _opts,
+	                             translation& _translation,
+	                             request_metrics* _metrics) -> int;
+
+	// Logs the query of _translation, along with its plan, if the request described by
+	// _metrics took at least as long as the slow query threshold. Does nothing if the slow
+	// query log is disabled.
+	auto log_slow_query(std::string_view _query_string,
+	                    const translation& _translation,
+	                    const request_metrics& _metrics) -> void;
+
+	// Returns the statement timeout of a request which asked for _requested_seconds. Zero
+	// selects the configured default. The result is capped at the configured maximum. A
+	// result of zero means the statement has no deadline.
+	auto statement_timeout(int _requested_seconds) -> std::chrono::seconds;
+
+	// Returns the socket of the client of _comm if statements are cancelled when the client
+	// disconnects. Otherwise, returns -1. See statement_watchdog.
+	auto watched_client_socket(const RsComm& _comm) -> int;
+
+	// Returns the size limit of the rows of a response for a request which asked for
+	// _requested_bytes. Zero means the request did not ask for a limit. The result is capped
+	// at the configured maximum. std::numeric_limits<std::size_t>::max() means no limit.
+	auto response_byte_budget(int _requested_bytes) -> std::size_t;
+
+	auto to_base64(std::string_view _bytes) -> std::string;
+
+	// Executes a prepared statement produced by _translation, storing the rows in _result.
+	auto execute(nanodbc::statement& _stmt,
+	             const translation& _translation,
+	             std::optional<bulk_result>& _result,
+	             request_metrics* _metrics) -> void;
+
+	// Writes at most _max_rows rows to _writer as a JSON array of arrays of strings. Rows
+	// are no longer written once the array reaches _max_bytes bytes. The limit is checked
+	// before each row, so a non-zero _max_bytes lets at least one row through and cursors
+	// always make progress.
+	// _has_pending_row indicates the current row of _result has not been written yet.
+	//
+	// Returns true if more rows are available.
+	auto read_json_rows(bulk_result& _result,
+	                    bool _has_pending_row,
+	                    std::size_t _max_rows,
+	                    std::size_t _max_bytes,
+	                    json_stream_writer& _writer,
+	                    request_metrics* _metrics) -> bool;
+
+	// Same as read_json_rows, but appends the rows to an Apache Arrow record batch. The size
+	// of the rows is approximated by the length of their values.
+	auto read_arrow_rows(bulk_result& _result,
+	                     bool _has_pending_row,
+	                     std::size_t _max_rows,
+	                     std::size_t _max_bytes,
+	                     arrow_stream_writer& _writer,
+	                     request_metrics* _metrics) -> bool;
+} // namespace irods::experimental::genquery2
+
+#endif // IRODS_API_PLUGIN_GENQUERY2_PRIVATE_SERVER_UTILITIES_HPP
@@ -0,0 +1,104 @@
+#ifndef IRODS_API_PLUGIN_GENQUERY2_PRIVATE_STATEMENT_WATCHDOG_HPP
+#define IRODS_API_PLUGIN_GENQUERY2_PRIVATE_STATEMENT_WATCHDOG_HPP
+
+// This file is for the implementation of the plugin. Symbols declared and/or defined in
+// this header MUST NOT be used outside of the plugin.
+
+#include <nanodbc/nanodbc.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace irods::experimental::genquery2
+{
+	// Why a statement was cancelled.
+	enum class cancel_reason
+	{
+		none,
+		timeout,
+		client_disconnected
+	}; // enum class cancel_reason
+
+	// Thrown by statement_watchdog::run when the watched operation failed because the
+	// statement was cancelled.
+	class statement_cancelled : public std::runtime_error
+	{
+	  public:
+		explicit statement_cancelled(cancel_reason _reason);
+
+		auto reason() const noexcept -> cancel_reason
+		{
+			return reason_;
+		} // reason
+
+		// Returns the error code reported to the client. See GENQUERY2_STATEMENT_TIMEOUT.
+		auto error_code() const noexcept -> int;
+
+	  private:
+		cancel_reason reason_;
+	}; // class statement_cancelled
+
+	// Cancels a statement when its deadline passes or when the client closes its connection,
+	// whichever happens first. The statement is watched by a separate thread for the lifetime
+	// of the watchdog, so the watchdog must be destroyed before the statement. If there is
+	// neither a deadline nor a client to watch, no thread is started and the watchdog does
+	// nothing.
+	//
+	// ODBC allows SQLCancel to be called while another thread is executing a function on the
+	// same statement. The interrupted function then fails with a database error.
+	class statement_watchdog
+	{
+	  public:
+		// A _timeout of zero means the statement has no deadline. A negative _client_socket
+		// disables watching the client.
+		statement_watchdog(nanodbc::statement& _statement, int _client_socket, std::chrono::seconds _timeout);
+
+		statement_watchdog(const statement_watchdog&) = delete;
+		auto operator=(const statement_watchdog&) -> statement_watchdog& = delete;
+
+		~statement_watchdog();
+
+		auto reason() const noexcept -> cancel_reason;
+
+		// Invokes _func. If _func throws a database error after the statement was cancelled,
+		// statement_cancelled is thrown instead.
+		template <typename Func>
+		auto run(Func&& _func) -> decltype(auto)
+		{
+			try {
+				return std::forward<Func>(_func)();
+			}
+			catch (const nanodbc::database_error&) {
+				if (const auto r = reason(); r != cancel_reason::none) {
+					throw statement_cancelled{r};
+				}
+
+				throw;
+			}
+		} // run
+
+	  private:
+		auto watch(std::chrono::steady_clock::time_point _deadline) -> void;
+
+		auto client_disconnected() const noexcept -> bool;
+
+		auto cancel(cancel_reason _reason) -> void;
+
+		void* handle_;
+		int client_socket_;
+		std::atomic<cancel_reason> reason_{cancel_reason::none};
+		std::mutex mutex_;
+		std::condition_variable cv_;
+		bool stopped_ = false;
+
+		// Declared last so that the members above are initialized before the thread starts.
+		std::thread thread_;
+	}; // class statement_watchdog
+} // namespace irods::experimental::genquery2
+
+#endif // IRODS_API_PLUGIN_GENQUERY2_PRIVATE_STATEMENT_WATCHDOG_HPP
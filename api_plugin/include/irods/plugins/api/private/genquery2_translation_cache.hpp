@@ -0,0 +1,113 @@
+#ifndef IRODS_API_PLUGIN_GENQUERY2_PRIVATE_TRANSLATION_CACHE_HPP
+#define IRODS_API_PLUGIN_GENQUERY2_PRIVATE_TRANSLATION_CACHE_HPP
+
+// This file is for the implementation of the plugin. Symbols declared and/or defined in
+// this header MUST NOT be used outside of the plugin.
+
+#include "irods/plugins/api/private/genquery2_resource_hierarchy_cache.hpp"
+#include "irods/plugins/api/private/genquery2_result_column.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace irods::experimental::genquery2
+{
+	// Identifies a GenQuery2 string along with the options which influence the SQL
+	// generated for it. The username is intentionally excluded. See translation.
+	struct translation_key
+	{
+		std::string query_string;
+		std::string database;
+		std::uint16_t default_number_of_rows = 0;
+		std::uint64_t max_number_of_rows = 0;
+		bool admin_mode = false;
+		bool count_only = false;
+
+		// The version of the resource hierarchies used to translate the string, or zero if
+		// none were used. See resource_hierarchy_cache.
+		std::uint64_t resource_hierarchy_version = 0;
+
+		auto operator==(const translation_key& _rhs) const -> bool = default;
+	}; // struct translation_key
+
+	// Holds the result of converting a GenQuery2 string into SQL.
+	struct translation
+	{
+		std::string sql;
+
+		// The bindable values, in the order of their placeholders.
+		std::vector<std::string> values;
+
+		// The positions within "values" which must be replaced with the name of the user
+		// executing the query. This is what allows one translation to serve all users.
+		std::vector<std::size_t> username_value_positions;
+
+		// The columns of the result set, in the order they appear in each row.
+		std::vector<result_column> columns;
+
+		// The positions of the columns which hold a resource ID that must be replaced with
+		// its hierarchy. See bulk_result::resolve_resource_hierarchies.
+		std::vector<std::size_t> resource_hierarchy_columns;
+
+		// The GenQuery2 string with its literals replaced by placeholders, and its hash. Queries
+		// which differ only in their literals share both. See gq::normalize.
+		std::string normalized_query;
+		std::uint64_t fingerprint = 0;
+
+		// The hierarchies the resource IDs are resolved with. Not stored in the cache.
+		std::shared_ptr<const resource_hierarchy_snapshot> resource_hierarchies;
+	}; // struct translation
+
+	struct translation_cache_statistics
+	{
+		std::uint64_t hits = 0;
+		std::uint64_t misses = 0;
+		std::uint64_t evictions = 0;
+		std::size_t size = 0;
+		std::size_t capacity = 0;
+	}; // struct translation_cache_statistics
+
+	// A bounded, least-recently-used cache of translations. A capacity of zero disables
+	// the cache.
+	class translation_cache
+	{
+	  public:
+		explicit translation_cache(std::size_t _capacity);
+
+		// Returns a copy of the translation mapped to _key and marks it as the most recently
+		// used entry. Returns an empty optional if no translation exists for _key.
+		auto find(const translation_key& _key) -> std::optional<translation>;
+
+		// Adds or replaces the translation mapped to _key. The least recently used entry is
+		// evicted if the cache is full.
+		auto insert(translation_key _key, translation _translation) -> void;
+
+		auto statistics() const -> translation_cache_statistics;
+
+	  private:
+		struct key_hash
+		{
+			auto operator()(const translation_key& _key) const noexcept -> std::size_t;
+		}; // struct key_hash
+
+		using entry_list = std::list<std::pair<translation_key, translation>>;
+
+		mutable std::mutex mutex_;
+		std::size_t capacity_;
+		entry_list entries_;
+		std::unordered_map<translation_key, entry_list::iterator, key_hash> index_;
+		std::uint64_t hits_ = 0;
+		std::uint64_t misses_ = 0;
+		std::uint64_t evictions_ = 0;
+	}; // class translation_cache
+} // namespace irods::experimental::genquery2
+
+#endif // IRODS_API_PLUGIN_GENQUERY2_PRIVATE_TRANSLATION_CACHE_HPP
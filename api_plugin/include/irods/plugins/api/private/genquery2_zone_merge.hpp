@@ -0,0 +1,71 @@
+#ifndef IRODS_API_PLUGIN_GENQUERY2_PRIVATE_ZONE_MERGE_HPP
+#define IRODS_API_PLUGIN_GENQUERY2_PRIVATE_ZONE_MERGE_HPP
+
+// This file is for the implementation of the plugin. Symbols declared and/or defined in
+// this header MUST NOT be used outside of the plugin.
+
+#include "irods/plugins/api/private/genquery2_json_stream_writer.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace irods::experimental::genquery2
+{
+	// Describes how the results of a query executed in several zones are combined into one.
+	struct merge_spec
+	{
+		struct sort_key
+		{
+			// The position of the sorted column within a row.
+			std::size_t index = 0;
+
+			bool ascending = true;
+
+			// Integer and timestamp columns are compared by value. All other columns are
+			// compared byte-wise.
+			bool numeric = false;
+		}; // struct sort_key
+
+		// Derived from the ORDER BY clause. Empty if the query does not sort its rows.
+		std::vector<sort_key> sort_keys;
+
+		// The maximum number of rows in the merged result.
+		std::size_t limit = 0;
+	}; // struct merge_spec
+
+	// The outcome of executing the query in one zone.
+	struct zone_result
+	{
+		std::string zone;
+
+		// Zero on success, in which case rows holds the JSON array of rows returned by the zone.
+		int error_code = 0;
+		nlohmann::json rows = nlohmann::json::array();
+	}; // struct zone_result
+
+	// Derives the merge_spec of a GenQuery2 string. _default_number_of_rows is the limit used
+	// if the query does not contain one. _byte_order_collation indicates the zones sort
+	// strings byte-wise, as the merge does.
+	//
+	// Throws std::invalid_argument if the string cannot be parsed or the query cannot be
+	// merged correctly (i.e. it contains an OFFSET, or sorts by a string column and the zones
+	// may use a different collation).
+	auto make_merge_spec(std::string_view _query_string,
+	                     std::size_t _default_number_of_rows,
+	                     bool _byte_order_collation) -> merge_spec;
+
+	// Writes {"rows": [...], "errors": [...]} to _writer.
+	//
+	// Each row is prefixed with the name of the zone it came from. The rows of every zone
+	// are expected to be sorted according to _spec already, so they are combined via a
+	// k-way merge and truncated to _spec.limit. Zones which failed are listed in "errors"
+	// along with their error code.
+	auto merge_zone_results(const std::vector<zone_result>& _results, const merge_spec& _spec, json_stream_writer& _writer)
+		-> void;
+} // namespace irods::experimental::genquery2
+
+#endif // IRODS_API_PLUGIN_GENQUERY2_PRIVATE_ZONE_MERGE_HPP
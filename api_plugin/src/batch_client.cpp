@@ -0,0 +1,4 @@
+#include "irods/plugins/api/private/genquery2_batch_common.hpp"
+
+const batch_operation_type batch_op;
+funcPtr batch_fn_ptr = nullptr;
@@ -0,0 +1,252 @@
+#include "irods/plugins/api/private/genquery2_batch_common.hpp"
+#include "irods/plugins/api/genquery2_common.h" // For API plugin number.
+#include "irods/plugins/api/private/genquery2_server_utilities.hpp"
+#include "irods/plugins/api/private/genquery2_statement_watchdog.hpp"
+
+#include "irods/genquery2_sql.hpp"
+
+#include <irods/apiHandler.hpp>
+#include <irods/irods_logger.hpp>
+#include <irods/irods_rs_comm_query.hpp>
+#include <irods/procApiRequest.h>
+#include <irods/rodsConnect.h>
+#include <irods/rodsErrorTable.h>
+
+#include <fmt/format.h>
+#include <nanodbc/nanodbc.h>
+
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+	namespace gq = irods::experimental::api::genquery;
+	namespace gq2 = irods::experimental::genquery2;
+
+	using log_api = irods::experimental::log::api;
+
+	//
+	// Function Prototypes
+	//
+
+	auto execute_query(RsComm* _comm,
+	                   nanodbc::connection& _conn,
+	                   const char* _query_string,
+	                   const gq::options& _opts,
+	                   gq2::json_stream_writer& _writer) -> int;
+
+	auto call_genquery2_batch(irods::api_entry*, RsComm*, const genquery2_batch_input*, char**) -> int;
+
+	auto rs_genquery2_batch(RsComm*, const genquery2_batch_input*, char**) -> int;
+
+	//
+	// Function Implementations
+	//
+
+	auto execute_query(RsComm* _comm,
+	                   nanodbc::connection& _conn,
+	                   const char* _query_string,
+	                   const gq::options& _opts,
+	                   gq2::json_stream_writer& _writer) -> int
+	{
+		if (!_query_string) {
+			log_api::error("Invalid input: received nullptr for query string.");
+			return SYS_INVALID_INPUT_PARAM;
+		}
+
+		// The slow query log is the only consumer of metrics in a batch, so they are only
+		// collected if it is enabled.
+		std::optional<gq2::request_metrics> metrics;
+
+		if (gq2::get_plugin_configuration().slow_query_threshold.count() > 0) {
+			metrics.emplace();
+		}
+
+		auto* m = metrics ? &*metrics : nullptr;
+
+		try {
+			// Admission control may limit the number of rows of this query without affecting
+			// the others.
+			auto opts = _opts;
+			auto translation = gq2::translate(_query_string, opts, m);
+
+			if (translation.sql.empty()) {
+				log_api::error("Could not generate SQL from GenQuery.");
+				return SYS_INVALID_INPUT_PARAM;
+			}
+
+			// May replace the translation with one which produces fewer rows.
+			if (const auto ec = gq2::apply_admission_control(_comm, _query_string, opts, translation, m); ec < 0) {
+				return ec;
+			}
+
+			const auto& sql = translation.sql;
+			const auto& values = translation.values;
+
+			nanodbc::statement stmt{_conn};
+
+			{
+				const gq2::phase_timer timer{m, &gq2::request_metrics::prepare};
+
+				nanodbc::prepare(stmt, sql);
+
+				for (std::vector<std::string>::size_type i = 0; i < values.size(); ++i) {
+					stmt.bind(static_cast<short>(i), values.at(i).c_str());
+				}
+			}
+
+			// The batch input has no timeout of its own, so each query is subject to the
+			// default timeout of the server.
+			gq2::statement_watchdog watchdog{stmt, gq2::watched_client_socket(*_comm), gq2::statement_timeout(0)};
+
+			// The maximum response size applies to the response of the batch as a whole.
+			const auto max_bytes = gq2::response_byte_budget(0);
+			const auto start_of_rows = _writer.size();
+			const auto remaining_bytes = (start_of_rows < max_bytes) ? max_bytes - start_of_rows : 0;
+
+			const auto truncated = watchdog.run([&] {
+				std::optional<gq2::bulk_result> result;
+				gq2::execute(stmt, translation, result, m);
+
+				return gq2::read_json_rows(
+					*result, false, std::numeric_limits<std::size_t>::max(), remaining_bytes, _writer, m);
+			});
+
+			if (truncated) {
+				log_api::error("GenQuery2 batch response exceeds the maximum response size of [{}] bytes.", max_bytes);
+				return GENQUERY2_RESPONSE_TOO_LARGE;
+			}
+
+			if (m) {
+				m->finish(_writer.size() - start_of_rows);
+				gq2::log_slow_query(_query_string, translation, *m);
+			}
+		}
+		catch (const gq2::statement_cancelled& e) {
+			// There is no point in executing the remaining queries if the client is gone.
+			if (gq2::cancel_reason::client_disconnected == e.reason()) {
+				throw;
+			}
+
+			log_api::error("GenQuery2 batch query was cancelled: {}", e.what());
+			return e.error_code();
+		}
+		catch (const nanodbc::database_error& e) {
+			log_api::error("Caught database exception while executing query: {}", e.what());
+			return SYS_LIBRARY_ERROR;
+		}
+		catch (const std::exception& e) {
+			log_api::error("Caught exception while executing query: {}", e.what());
+			return SYS_LIBRARY_ERROR;
+		}
+
+		return 0;
+	} // execute_query
+
+	auto call_genquery2_batch(irods::api_entry* _api,
+	                          RsComm* _comm,
+	                          const genquery2_batch_input* _input,
+	                          char** _output) -> int
+	{
+		return _api->call_handler<const genquery2_batch_input*, char**>(_comm, _input, _output);
+	} // call_genquery2_batch
+
+	auto rs_genquery2_batch(RsComm* _comm, const genquery2_batch_input* _input, char** _output) -> int
+	{
+		if (!_input || !_output || _input->number_of_queries <= 0 || !_input->query_strings) {
+			log_api::error("Invalid input: received nullptr for message pointer and/or response pointer, "
+			               "or no query strings.");
+			return SYS_INVALID_INPUT_PARAM;
+		}
+
+		log_api::trace("GenQuery2 batch API endpoint received: number_of_queries=[{}], zone=[{}]",
+		               _input->number_of_queries,
+		               _input->zone ? _input->zone : "nullptr");
+
+		// Redirect to the catalog service provider based on the user-provided zone.
+		// This allows clients to query federated zones.
+		rodsServerHost* host_info{};
+
+		if (const auto ec = gq2::resolve_catalog_provider(_comm, _input->zone, &host_info); ec < 0) {
+			return ec;
+		}
+
+		if (host_info->localFlag != LOCAL_HOST) {
+			log_api::trace("Redirecting request to remote zone [{}].", _input->zone);
+
+			return procApiRequest(
+				host_info->conn,
+				IRODS_APN_GENQUERY2_BATCH,
+				_input,
+				nullptr,
+				reinterpret_cast<void**>(_output), // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+				nullptr);
+		}
+
+		//
+		// At this point, we assume we're connected to the catalog service provider.
+		//
+
+		try {
+			gq::options opts;
+
+			opts.database = gq2::get_plugin_configuration().database;
+			opts.username = _comm->clientUser.userName;
+			opts.admin_mode = irods::is_privileged_client(*_comm);
+
+			// Every query in the batch is executed on this connection.
+			auto db_conn = gq2::get_connection_pool().acquire();
+			gq2::log_connection_pool_statistics();
+
+			gq2::json_stream_writer writer;
+			writer.raw("[");
+
+			for (int i = 0; i < _input->number_of_queries; ++i) {
+				const auto* query_string = _input->query_strings[i];
+
+				log_api::trace("Executing GenQuery2 batch query [{}]: [{}]", i, query_string ? query_string : "nullptr");
+
+				if (i > 0) {
+					writer.raw(",");
+				}
+
+				// The rows are written before the error code is known. If the query fails, the
+				// object is rewritten so that it only contains the error code.
+				const auto start_of_object = writer.size();
+				writer.raw(R"({"error_code":0,"rows":)");
+
+				if (const auto ec = execute_query(_comm, db_conn.get(), query_string, opts, writer); ec < 0) {
+					writer.truncate(start_of_object);
+					writer.raw(fmt::format(R"({{"error_code":{}}})", ec));
+					continue;
+				}
+
+				writer.raw("}");
+			}
+
+			writer.raw("]");
+
+			*_output = writer.release();
+		}
+		catch (const gq2::statement_cancelled& e) {
+			log_api::error("GenQuery2 batch was cancelled: {}", e.what());
+			return e.error_code();
+		}
+		catch (const nanodbc::database_error& e) {
+			log_api::error("Caught database exception while executing batch: {}", e.what());
+			return SYS_LIBRARY_ERROR;
+		}
+		catch (const std::exception& e) {
+			log_api::error("Caught exception while executing batch: {}", e.what());
+			return SYS_LIBRARY_ERROR;
+		}
+
+		return 0;
+	} // rs_genquery2_batch
+} //namespace
+
+const batch_operation_type batch_op = rs_genquery2_batch;
+auto batch_fn_ptr = reinterpret_cast<funcPtr>(call_genquery2_batch);
@@ -0,0 +1,30 @@
+#include "irods/plugins/api/private/genquery2_admission_control.hpp"
+
+namespace irods::experimental::genquery2
+{
+	auto to_admission_threshold(const nlohmann::json& _config) -> admission_threshold
+	{
+		admission_threshold t;
+
+		t.max_estimated_cost = _config.value("max_estimated_cost", t.max_estimated_cost);
+		t.max_estimated_rows = _config.value("max_estimated_rows", t.max_estimated_rows);
+		t.row_limit = _config.value("row_limit", t.row_limit);
+
+		return t;
+	} // to_admission_threshold
+
+	auto decide(const admission_threshold& _threshold, const plan_estimate& _estimate) noexcept
+		-> admission_decision
+	{
+		const auto too_costly = _threshold.max_estimated_cost > 0 && _estimate.cost > _threshold.max_estimated_cost;
+
+		// Databases which do not estimate the number of rows report a negative value.
+		const auto too_many_rows = _threshold.max_estimated_rows > 0 && _estimate.rows > _threshold.max_estimated_rows;
+
+		if (!too_costly && !too_many_rows) {
+			return admission_decision::admit;
+		}
+
+		return (_threshold.row_limit > 0) ? admission_decision::limit : admission_decision::reject;
+	} // decide
+} // namespace irods::experimental::genquery2
@@ -0,0 +1,457 @@
+#include "irods/plugins/api/private/genquery2_arrow_stream_writer.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+// The Arrow IPC format is described at https://arrow.apache.org/docs/format/Columnar.html.
+// Message metadata is encoded using FlatBuffers. The small subset of FlatBuffers needed to
+// describe a schema and a record batch is implemented below so that the plugin does not
+// depend on the Arrow or FlatBuffers libraries.
+
+namespace
+{
+	namespace gq = irods::experimental::api::genquery;
+
+	// Values from the Arrow FlatBuffers schema (Schema.fbs and Message.fbs).
+	constexpr std::int16_t metadata_version_v5 = 4;
+	constexpr std::uint8_t message_header_schema = 1;
+	constexpr std::uint8_t message_header_record_batch = 3;
+	constexpr std::uint8_t type_int = 2;
+	constexpr std::uint8_t type_utf8 = 5;
+	constexpr std::uint8_t type_timestamp = 10;
+	constexpr std::int16_t time_unit_second = 0;
+
+	constexpr std::uint32_t continuation_marker = 0xFFFFFFFF;
+
+	// Every buffer in a message body must start on an 8-byte boundary.
+	constexpr std::size_t body_alignment = 8;
+
+	// A field of a FlatBuffers table. Offset fields are written as zero and patched via
+	// flatbuffer_builder::link once the object they refer to has been written.
+	struct table_field
+	{
+		std::uint16_t slot;
+		std::uint8_t size;
+		std::uint64_t value = 0;
+	}; // struct table_field
+
+	// Encodes FlatBuffers front to back. Offsets in FlatBuffers must point forward, so
+	// objects are always written before the objects they refer to.
+	class flatbuffer_builder
+	{
+	  public:
+		flatbuffer_builder()
+		{
+			// The offset of the root table. See set_root.
+			put<std::uint32_t>(0);
+		}
+
+		template <typename T>
+		auto put(T _value) -> std::size_t
+		{
+			const auto pos = buf_.size();
+			buf_.resize(pos + sizeof(T));
+			write_le(pos, _value);
+			return pos;
+		}
+
+		auto align(std::size_t _alignment) -> void
+		{
+			buf_.resize((buf_.size() + _alignment - 1) / _alignment * _alignment, '\0');
+		}
+
+		// Makes the uoffset at _pos refer to the object at _target.
+		auto link(std::size_t _pos, std::size_t _target) -> void
+		{
+			write_le(_pos, static_cast<std::uint32_t>(_target - _pos));
+		}
+
+		auto set_root(std::size_t _table) -> void
+		{
+			link(0, _table);
+		}
+
+		// Writes a table and its vtable. Returns the position of the table. The position of
+		// each field is stored in _field_positions, indexed by slot.
+		auto table(std::vector<table_field> _fields, std::vector<std::size_t>* _field_positions = nullptr)
+			-> std::size_t
+		{
+			// Sorting by size keeps every field naturally aligned without padding.
+			std::stable_sort(std::begin(_fields), std::end(_fields), [](const auto& _a, const auto& _b) {
+				return _a.size > _b.size;
+			});
+
+			std::uint16_t n_slots = 0;
+			for (const auto& f : _fields) {
+				n_slots = std::max(n_slots, static_cast<std::uint16_t>(f.slot + 1));
+			}
+
+			const auto has_8_byte_fields = !_fields.empty() && _fields.front().size == 8;
+
+			// The table begins with the offset to its vtable.
+			std::uint16_t table_size = has_8_byte_fields ? 8 : 4;
+			std::vector<std::uint16_t> vtable(n_slots, 0);
+
+			for (const auto& f : _fields) {
+				vtable[f.slot] = table_size;
+				table_size = static_cast<std::uint16_t>(table_size + f.size);
+			}
+
+			align(2);
+			const auto vtable_pos = put<std::uint16_t>(static_cast<std::uint16_t>(4 + 2 * n_slots));
+			put<std::uint16_t>(table_size);
+			for (auto offset : vtable) {
+				put<std::uint16_t>(offset);
+			}
+
+			// A table locates its vtable by subtracting this offset from its own position.
+			align(has_8_byte_fields ? 8 : 4);
+			const auto table_pos = put(static_cast<std::int32_t>(buf_.size() - vtable_pos));
+			align(has_8_byte_fields ? 8 : 4);
+
+			if (_field_positions) {
+				_field_positions->assign(n_slots, 0);
+			}
+
+			for (const auto& f : _fields) {
+				std::size_t pos = 0;
+
+				switch (f.size) {
+					case 1: pos = put(static_cast<std::uint8_t>(f.value)); break;
+					case 2: pos = put(static_cast<std::uint16_t>(f.value)); break;
+					case 4: pos = put(static_cast<std::uint32_t>(f.value)); break;
+					default: pos = put(f.value); break;
+				}
+
+				if (_field_positions) {
+					(*_field_positions)[f.slot] = pos;
+				}
+			}
+
+			return table_pos;
+		}
+
+		// Writes a null-terminated string. Returns its position.
+		auto string(std::string_view _s) -> std::size_t
+		{
+			align(4);
+			const auto pos = put(static_cast<std::uint32_t>(_s.size()));
+			buf_.append(_s);
+			buf_.push_back('\0');
+			return pos;
+		}
+
+		// Writes a vector of _count offsets, each of which must be linked by the caller. The
+		// offset of element i is located at the returned position + 4 + 4 * i.
+		auto vector_of_offsets(std::size_t _count) -> std::size_t
+		{
+			align(4);
+			const auto pos = put(static_cast<std::uint32_t>(_count));
+			buf_.resize(buf_.size() + 4 * _count, '\0');
+			return pos;
+		}
+
+		// Writes a vector of structs made of 64-bit integers. Returns its position.
+		auto vector_of_structs(const std::vector<std::int64_t>& _members, std::size_t _members_per_struct)
+			-> std::size_t
+		{
+			// The elements must be 8-byte aligned, and they follow the 4-byte length.
+			align(4);
+			if (buf_.size() % 8 == 0) {
+				put<std::uint32_t>(0);
+			}
+
+			const auto pos = put(static_cast<std::uint32_t>(_members.size() / _members_per_struct));
+			for (auto m : _members) {
+				put(m);
+			}
+
+			return pos;
+		}
+
+		auto release() -> std::string
+		{
+			return std::move(buf_);
+		}
+
+	  private:
+		template <typename T>
+		auto write_le(std::size_t _pos, T _value) -> void
+		{
+			using unsigned_type = std::make_unsigned_t<T>;
+			auto v = static_cast<unsigned_type>(_value);
+
+			for (std::size_t i = 0; i < sizeof(T); ++i) {
+				buf_[_pos + i] = static_cast<char>(v & 0xFF);
+				v = static_cast<unsigned_type>(v >> 8);
+			}
+		}
+
+		std::string buf_;
+	}; // class flatbuffer_builder
+
+	template <typename T>
+	auto append_le(std::string& _out, T _value) -> void
+	{
+		using unsigned_type = std::make_unsigned_t<T>;
+		auto v = static_cast<unsigned_type>(_value);
+
+		for (std::size_t i = 0; i < sizeof(T); ++i) {
+			_out.push_back(static_cast<char>(v & 0xFF));
+			v = static_cast<unsigned_type>(v >> 8);
+		}
+	} // append_le
+
+	auto pad(std::string& _out, std::size_t _alignment) -> void
+	{
+		_out.resize((_out.size() + _alignment - 1) / _alignment * _alignment, '\0');
+	} // pad
+
+	// Frames the metadata and body as an encapsulated IPC message.
+	auto append_message(std::string& _out, std::string _metadata, std::string_view _body) -> void
+	{
+		// The metadata length includes the padding which aligns the body to 8 bytes.
+		pad(_metadata, 8);
+
+		append_le(_out, continuation_marker);
+		append_le(_out, static_cast<std::int32_t>(_metadata.size()));
+		_out.append(_metadata);
+		_out.append(_body);
+	} // append_message
+
+	// Writes the Message table which wraps a schema or record batch. Returns the position of
+	// the header's offset field, which must be linked to the header.
+	auto write_message_table(flatbuffer_builder& _fbb, std::uint8_t _header_type, std::int64_t _body_length)
+		-> std::size_t
+	{
+		std::vector<std::size_t> positions;
+
+		const auto message = _fbb.table({{.slot = 0, .size = 2, .value = metadata_version_v5},
+		                                 {.slot = 1, .size = 1, .value = _header_type},
+		                                 {.slot = 2, .size = 4},
+		                                 {.slot = 3, .size = 8, .value = static_cast<std::uint64_t>(_body_length)}},
+		                                &positions);
+		_fbb.set_root(message);
+
+		return positions[2];
+	} // write_message_table
+} // anonymous namespace
+
+namespace irods::experimental::genquery2
+{
+	arrow_stream_writer::arrow_stream_writer(std::vector<result_column> _columns)
+	{
+		columns_.reserve(_columns.size());
+
+		for (auto& c : _columns) {
+			auto& builder = columns_.emplace_back();
+			builder.column = std::move(c);
+
+			if (builder.column.type == gq::column_type::string) {
+				builder.offsets.push_back(0);
+			}
+		}
+	} // arrow_stream_writer::arrow_stream_writer
+
+	auto arrow_stream_writer::append(std::string_view _value) -> void
+	{
+		if (columns_.at(current_column_).column.type == gq::column_type::string) {
+			auto& builder = next_column(true);
+			builder.data.append(_value);
+
+			if (builder.data.size() > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max())) {
+				throw std::length_error{"Arrow stream writer: string column exceeds 2 GiB."};
+			}
+
+			builder.offsets.push_back(static_cast<std::int32_t>(builder.data.size()));
+			end_column();
+			return;
+		}
+
+		std::int64_t v{};
+		const auto* last = _value.data() + _value.size();
+		const auto [ptr, ec] = std::from_chars(_value.data(), last, v);
+
+		if (ec != std::errc{} || ptr != last) {
+			append_null();
+			return;
+		}
+
+		append_le(next_column(true).data, v);
+		end_column();
+	} // arrow_stream_writer::append
+
+	auto arrow_stream_writer::append_null() -> void
+	{
+		auto& builder = next_column(false);
+		++builder.null_count;
+
+		// Null slots still occupy space in the data buffers.
+		if (builder.column.type == gq::column_type::string) {
+			builder.offsets.push_back(builder.offsets.back());
+		}
+		else {
+			append_le(builder.data, std::int64_t{0});
+		}
+
+		end_column();
+	} // arrow_stream_writer::append_null
+
+	auto arrow_stream_writer::number_of_rows() const noexcept -> std::int64_t
+	{
+		return rows_;
+	} // arrow_stream_writer::number_of_rows
+
+	auto arrow_stream_writer::finish() const -> std::string
+	{
+		std::string out;
+
+		write_schema_message(out);
+		write_record_batch_message(out);
+
+		// End-of-stream marker.
+		append_le(out, continuation_marker);
+		append_le(out, std::int32_t{0});
+
+		return out;
+	} // arrow_stream_writer::finish
+
+	auto arrow_stream_writer::next_column(bool _is_valid) -> column_builder&
+	{
+		auto& builder = columns_.at(current_column_);
+		const auto bit = static_cast<std::size_t>(rows_ % 8);
+
+		if (bit == 0) {
+			builder.validity.push_back(0);
+		}
+
+		if (_is_valid) {
+			builder.validity.back() = static_cast<std::uint8_t>(builder.validity.back() | (1u << bit));
+		}
+
+		return builder;
+	} // arrow_stream_writer::next_column
+
+	auto arrow_stream_writer::end_column() noexcept -> void
+	{
+		if (++current_column_ == columns_.size()) {
+			current_column_ = 0;
+			++rows_;
+		}
+	} // arrow_stream_writer::end_column
+
+	auto arrow_stream_writer::write_schema_message(std::string& _out) const -> void
+	{
+		flatbuffer_builder fbb;
+
+		const auto header_field = write_message_table(fbb, message_header_schema, 0);
+
+		// Schema.fields is slot 1. Slot 0 is the endianness, which defaults to little-endian.
+		std::vector<std::size_t> positions;
+		const auto schema = fbb.table({{.slot = 1, .size = 4}}, &positions);
+		fbb.link(header_field, schema);
+
+		const auto fields = fbb.vector_of_offsets(columns_.size());
+		fbb.link(positions[1], fields);
+
+		for (std::size_t i = 0; i < columns_.size(); ++i) {
+			const auto& c = columns_[i].column;
+
+			std::uint8_t type_type = type_utf8;
+			if (c.type == gq::column_type::integer) {
+				type_type = type_int;
+			}
+			else if (c.type == gq::column_type::timestamp) {
+				type_type = type_timestamp;
+			}
+
+			// Field: name (0), nullable (1), type_type (2), type (3), children (5).
+			std::vector<std::size_t> field_positions;
+			const auto field = fbb.table({{.slot = 0, .size = 4},
+			                              {.slot = 1, .size = 1, .value = 1},
+			                              {.slot = 2, .size = 1, .value = type_type},
+			                              {.slot = 3, .size = 4},
+			                              {.slot = 5, .size = 4}},
+			                             &field_positions);
+			fbb.link(fields + 4 + 4 * i, field);
+
+			fbb.link(field_positions[0], fbb.string(c.name));
+
+			if (type_type == type_int) {
+				// Int: bitWidth (0), is_signed (1).
+				fbb.link(field_positions[3], fbb.table({{.slot = 0, .size = 4, .value = 64}, {.slot = 1, .size = 1, .value = 1}}));
+			}
+			else if (type_type == type_timestamp) {
+				// Timestamp: unit (0), timezone (1).
+				std::vector<std::size_t> ts_positions;
+				const auto ts =
+					fbb.table({{.slot = 0, .size = 2, .value = time_unit_second}, {.slot = 1, .size = 4}}, &ts_positions);
+				fbb.link(field_positions[3], ts);
+				fbb.link(ts_positions[1], fbb.string("UTC"));
+			}
+			else {
+				fbb.link(field_positions[3], fbb.table({}));
+			}
+
+			// Readers expect the children vector to be present even though it is always empty.
+			fbb.link(field_positions[5], fbb.vector_of_offsets(0));
+		}
+
+		append_message(_out, fbb.release(), {});
+	} // arrow_stream_writer::write_schema_message
+
+	auto arrow_stream_writer::write_record_batch_message(std::string& _out) const -> void
+	{
+		std::string body;
+		std::vector<std::int64_t> nodes;
+		std::vector<std::int64_t> buffers;
+
+		const auto add_buffer = [&body, &buffers](const void* _data, std::size_t _size) {
+			buffers.push_back(static_cast<std::int64_t>(body.size()));
+			buffers.push_back(static_cast<std::int64_t>(_size));
+			body.append(static_cast<const char*>(_data), _size);
+			pad(body, body_alignment);
+		};
+
+		for (const auto& c : columns_) {
+			nodes.push_back(rows_);
+			nodes.push_back(c.null_count);
+
+			// The validity buffer may be omitted when there are no nulls.
+			add_buffer(c.validity.data(), (c.null_count > 0) ? c.validity.size() : 0);
+
+			if (c.column.type == gq::column_type::string) {
+				std::string offsets;
+				offsets.reserve(c.offsets.size() * sizeof(std::int32_t));
+				for (auto o : c.offsets) {
+					append_le(offsets, o);
+				}
+
+				add_buffer(offsets.data(), offsets.size());
+			}
+
+			add_buffer(c.data.data(), c.data.size());
+		}
+
+		flatbuffer_builder fbb;
+
+		const auto header_field =
+			write_message_table(fbb, message_header_record_batch, static_cast<std::int64_t>(body.size()));
+
+		// RecordBatch: length (0), nodes (1), buffers (2).
+		std::vector<std::size_t> positions;
+		const auto record_batch = fbb.table(
+			{{.slot = 0, .size = 8, .value = static_cast<std::uint64_t>(rows_)}, {.slot = 1, .size = 4}, {.slot = 2, .size = 4}},
+			&positions);
+		fbb.link(header_field, record_batch);
+
+		// FieldNode and Buffer are both structs of two 64-bit integers.
+		fbb.link(positions[1], fbb.vector_of_structs(nodes, 2));
+		fbb.link(positions[2], fbb.vector_of_structs(buffers, 2));
+
+		append_message(_out, fbb.release(), body);
+	} // arrow_stream_writer::write_record_batch_message
+} // namespace irods::experimental::genquery2
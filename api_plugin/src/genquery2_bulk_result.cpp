@@ -0,0 +1,312 @@
+#include "irods/plugins/api/private/genquery2_bulk_result.hpp"
+
+#include <sqlext.h>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+	// The most memory the bound buffers of one result may use. The batch size is reduced
+	// for results with wide rows so that an agent holding several cursors stays small.
+	constexpr std::size_t max_rowset_buffer_size = 4 * 1024 * 1024;
+
+	// Values wider than this are read via SQLGetData instead of being bound.
+	constexpr std::size_t max_bound_value_size = 64 * 1024;
+
+	// Returns the size of the buffer needed to hold any value of the column as a
+	// null-terminated string, or zero if no fixed size buffer is guaranteed to be large enough.
+	auto buffer_width(SQLSMALLINT _data_type, SQLULEN _column_size) noexcept -> std::size_t
+	{
+		switch (_data_type) {
+			case SQL_LONGVARCHAR:
+			case SQL_WLONGVARCHAR:
+			case SQL_LONGVARBINARY:
+				return 0;
+
+			case SQL_CHAR:
+			case SQL_VARCHAR:
+			case SQL_WCHAR:
+			case SQL_WVARCHAR:
+				// The column size is measured in characters. A UTF-8 character needs at most 4 bytes.
+				return (_column_size == 0) ? 0 : _column_size * 4 + 1;
+
+			case SQL_BINARY:
+			case SQL_VARBINARY:
+				// Binary values are converted to two hex digits per byte.
+				return (_column_size == 0) ? 0 : _column_size * 2 + 1;
+
+			default:
+				// Numbers, dates, and times. The column size is the number of digits or
+				// characters, which leaves out signs, decimal points, and exponents.
+				return (_column_size == 0) ? 0 : _column_size + 64;
+		}
+	} // buffer_width
+
+	auto set_statement_attribute(SQLHSTMT _handle, SQLINTEGER _attribute, SQLPOINTER _value) -> void
+	{
+		if (!SQL_SUCCEEDED(SQLSetStmtAttr(_handle, _attribute, _value, 0))) {
+			throw nanodbc::database_error{_handle, SQL_HANDLE_STMT};
+		}
+	} // set_statement_attribute
+} // anonymous namespace
+
+namespace irods::experimental::genquery2
+{
+	bulk_result::bulk_result(nanodbc::statement& _statement, std::size_t _batch_size)
+		: handle_{_statement.native_statement_handle()}
+	{
+		// See the class description for why the statement is not executed via nanodbc.
+		set_statement_attribute(handle_, SQL_ATTR_PARAMSET_SIZE, reinterpret_cast<SQLPOINTER>(1)); // NOLINT(performance-no-int-to-ptr)
+
+		if (const auto rc = SQLExecute(handle_); !SQL_SUCCEEDED(rc) && rc != SQL_NO_DATA) {
+			throw nanodbc::database_error{handle_, SQL_HANDLE_STMT};
+		}
+
+		SQLSMALLINT n_cols = 0;
+		if (!SQL_SUCCEEDED(SQLNumResultCols(handle_, &n_cols))) {
+			throw nanodbc::database_error{handle_, SQL_HANDLE_STMT};
+		}
+
+		n_cols_ = n_cols;
+
+		bind_columns(_batch_size);
+	} // bulk_result::bulk_result
+
+	auto bulk_result::columns() const noexcept -> short
+	{
+		return n_cols_;
+	} // bulk_result::columns
+
+	auto bulk_result::batch_size() const noexcept -> std::size_t
+	{
+		return batch_size_;
+	} // bulk_result::batch_size
+
+	auto bulk_result::next() -> bool
+	{
+		if (!bound_columns_.empty() && current_row_ + 1 < rows_fetched_) {
+			++current_row_;
+			return true;
+		}
+
+		if (end_of_data_) {
+			return false;
+		}
+
+		const auto rc = SQLFetch(handle_);
+
+		if (rc == SQL_NO_DATA) {
+			end_of_data_ = true;
+			rows_fetched_ = 0;
+			return false;
+		}
+
+		if (!SQL_SUCCEEDED(rc)) {
+			throw nanodbc::database_error{handle_, SQL_HANDLE_STMT};
+		}
+
+		current_row_ = 0;
+
+		if (bound_columns_.empty()) {
+			read_unbound_values();
+			return true;
+		}
+
+		return rows_fetched_ > 0;
+	} // bulk_result::next
+
+	auto bulk_result::is_null(short _column) const -> bool
+	{
+		if (bound_columns_.empty()) {
+			return !unbound_values_.at(static_cast<std::size_t>(_column)).has_value();
+		}
+
+		return bound_columns_.at(static_cast<std::size_t>(_column)).indicators[current_row_] == SQL_NULL_DATA;
+	} // bulk_result::is_null
+
+	auto bulk_result::get_ref(short _column, const std::string& _fallback, std::string& _value) -> void
+	{
+		read_value(_column, _fallback, _value);
+
+		if (!resource_hierarchies_ || std::find(std::begin(resource_hierarchy_columns_),
+		                                        std::end(resource_hierarchy_columns_),
+		                                        static_cast<std::size_t>(_column)) == std::end(resource_hierarchy_columns_))
+		{
+			return;
+		}
+
+		if (const auto iter = resource_hierarchies_->hierarchies.find(_value);
+		    iter != std::end(resource_hierarchies_->hierarchies)) {
+			_value.assign(iter->second);
+			return;
+		}
+
+		// The resource was most likely created after the hierarchies were loaded. Returning
+		// null would be wrong, so the hierarchies are read again.
+		resource_hierarchies_->stale = true;
+
+		if (reload_resource_hierarchies_) {
+			if (auto snapshot = std::exchange(reload_resource_hierarchies_, nullptr)(); snapshot) {
+				resource_hierarchies_ = std::move(snapshot);
+
+				if (const auto iter = resource_hierarchies_->hierarchies.find(_value);
+				    iter != std::end(resource_hierarchies_->hierarchies)) {
+					_value.assign(iter->second);
+					return;
+				}
+			}
+		}
+
+		// The resource was removed after the row was produced, or the hierarchies could not be
+		// read.
+		_value.assign(_fallback);
+	} // bulk_result::get_ref
+
+	auto bulk_result::resolve_resource_hierarchies(std::vector<std::size_t> _columns,
+	                                               std::shared_ptr<const resource_hierarchy_snapshot> _snapshot,
+	                                               resource_hierarchy_loader _reload) -> void
+	{
+		resource_hierarchy_columns_ = std::move(_columns);
+		resource_hierarchies_ = std::move(_snapshot);
+		reload_resource_hierarchies_ = std::move(_reload);
+	} // bulk_result::resolve_resource_hierarchies
+
+	auto bulk_result::read_value(short _column, const std::string& _fallback, std::string& _value) const -> void
+	{
+		const auto col = static_cast<std::size_t>(_column);
+
+		if (bound_columns_.empty()) {
+			const auto& v = unbound_values_.at(col);
+			_value.assign(v ? *v : _fallback);
+			return;
+		}
+
+		const auto& bc = bound_columns_.at(col);
+		const auto indicator = bc.indicators[current_row_];
+
+		if (indicator == SQL_NULL_DATA) {
+			_value.assign(_fallback);
+			return;
+		}
+
+		// The buffers are sized so that this cannot happen with a conforming driver. Returning
+		// a truncated value would be worse than failing the query.
+		if (indicator < 0 || static_cast<std::size_t>(indicator) >= bc.width) {
+			throw std::runtime_error{fmt::format("Value of column [{}] does not fit in its fetch buffer.", _column)};
+		}
+
+		_value.assign(&bc.data[current_row_ * bc.width], static_cast<std::size_t>(indicator));
+	} // bulk_result::read_value
+
+	auto bulk_result::bind_columns(std::size_t _requested_batch_size) -> void
+	{
+		std::vector<std::size_t> widths;
+		widths.reserve(static_cast<std::size_t>(n_cols_));
+
+		for (SQLUSMALLINT i = 1; i <= static_cast<SQLUSMALLINT>(n_cols_); ++i) {
+			SQLSMALLINT data_type = 0;
+			SQLULEN column_size = 0;
+			SQLSMALLINT decimal_digits = 0;
+			SQLSMALLINT nullable = 0;
+
+			if (!SQL_SUCCEEDED(SQLDescribeCol(
+					handle_, i, nullptr, 0, nullptr, &data_type, &column_size, &decimal_digits, &nullable)))
+			{
+				throw nanodbc::database_error{handle_, SQL_HANDLE_STMT};
+			}
+
+			const auto width = buffer_width(data_type, column_size);
+
+			// Mixing bound columns and SQLGetData within a rowset is not supported by every
+			// driver, so one unbindable column means no column is bound.
+			if (width == 0 || width > max_bound_value_size) {
+				unbound_values_.resize(static_cast<std::size_t>(n_cols_));
+				return;
+			}
+
+			widths.push_back(width);
+		}
+
+		std::size_t row_width = 0;
+		for (auto w : widths) {
+			row_width += w;
+		}
+
+		const auto max_batch_size = std::max<std::size_t>(1, max_rowset_buffer_size / std::max<std::size_t>(1, row_width));
+		batch_size_ = std::clamp<std::size_t>(_requested_batch_size, 1, max_batch_size);
+
+		bound_columns_.resize(widths.size());
+
+		for (std::size_t i = 0; i < widths.size(); ++i) {
+			auto& bc = bound_columns_[i];
+			bc.width = widths[i];
+			bc.data.resize(bc.width * batch_size_);
+			bc.indicators.resize(batch_size_);
+
+			if (!SQL_SUCCEEDED(SQLBindCol(handle_,
+			                              static_cast<SQLUSMALLINT>(i + 1),
+			                              SQL_C_CHAR,
+			                              bc.data.data(),
+			                              static_cast<SQLLEN>(bc.width),
+			                              bc.indicators.data())))
+			{
+				throw nanodbc::database_error{handle_, SQL_HANDLE_STMT};
+			}
+		}
+
+		// NOLINTBEGIN(performance-no-int-to-ptr)
+		set_statement_attribute(handle_, SQL_ATTR_ROW_BIND_TYPE, reinterpret_cast<SQLPOINTER>(SQL_BIND_BY_COLUMN));
+		set_statement_attribute(
+			handle_, SQL_ATTR_ROW_ARRAY_SIZE, reinterpret_cast<SQLPOINTER>(static_cast<std::uintptr_t>(batch_size_)));
+		// NOLINTEND(performance-no-int-to-ptr)
+		set_statement_attribute(handle_, SQL_ATTR_ROWS_FETCHED_PTR, &rows_fetched_);
+	} // bulk_result::bind_columns
+
+	auto bulk_result::read_unbound_values() -> void
+	{
+		char buffer[1024];
+
+		// SQLGetData must be called for the columns in ascending order.
+		for (SQLUSMALLINT i = 1; i <= static_cast<SQLUSMALLINT>(n_cols_); ++i) {
+			auto& value = unbound_values_[i - 1];
+			value.reset();
+
+			while (true) {
+				SQLLEN indicator = 0;
+				const auto rc = SQLGetData(handle_, i, SQL_C_CHAR, buffer, sizeof(buffer), &indicator);
+
+				if (rc == SQL_NO_DATA) {
+					break;
+				}
+
+				if (!SQL_SUCCEEDED(rc)) {
+					throw nanodbc::database_error{handle_, SQL_HANDLE_STMT};
+				}
+
+				if (indicator == SQL_NULL_DATA) {
+					break;
+				}
+
+				if (!value) {
+					value.emplace();
+				}
+
+				// A truncated value fills the buffer (minus the null terminator), and the
+				// remainder is returned by the next call.
+				const auto n = (indicator == SQL_NO_TOTAL || static_cast<std::size_t>(indicator) >= sizeof(buffer))
+				                   ? sizeof(buffer) - 1
+				                   : static_cast<std::size_t>(indicator);
+				value->append(buffer, n);
+
+				if (rc == SQL_SUCCESS) {
+					break;
+				}
+			}
+		}
+	} // bulk_result::read_unbound_values
+} // namespace irods::experimental::genquery2
@@ -0,0 +1,33 @@
+#include "irods/plugins/api/private/genquery2_compression.hpp"
+
+#include <zlib.h>
+
+#include <fmt/format.h>
+
+#include <stdexcept>
+
+namespace irods::experimental::genquery2
+{
+	auto compress(std::string_view _bytes) -> std::string
+	{
+		// Responses are compressed once and sent immediately, so the default level gives a
+		// better trade-off between CPU time and size than the higher levels.
+		auto size = compressBound(static_cast<uLong>(_bytes.size()));
+		std::string compressed(size, '\0');
+
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+		if (const auto ec = compress2(reinterpret_cast<Bytef*>(compressed.data()),
+		                              &size,
+		                              reinterpret_cast<const Bytef*>(_bytes.data()),
+		                              static_cast<uLong>(_bytes.size()),
+		                              Z_DEFAULT_COMPRESSION);
+		    ec != Z_OK)
+		{
+			throw std::runtime_error{fmt::format("Could not compress result. [error code=[{}]]", ec)};
+		}
+
+		compressed.resize(size);
+
+		return compressed;
+	} // compress
+} // namespace irods::experimental::genquery2
@@ -0,0 +1,128 @@
+#include "irods/plugins/api/private/genquery2_connection_pool.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+namespace irods::experimental::genquery2
+{
+	connection_pool::connection_lease::connection_lease(connection_pool& _pool, nanodbc::connection _conn)
+		: pool_{&_pool}
+		, conn_{std::move(_conn)}
+		, uncaught_exceptions_{std::uncaught_exceptions()}
+	{
+	} // connection_lease::connection_lease
+
+	connection_pool::connection_lease::connection_lease(connection_lease&& _other) noexcept
+		: pool_{std::exchange(_other.pool_, nullptr)}
+		, conn_{std::move(_other.conn_)}
+		, uncaught_exceptions_{_other.uncaught_exceptions_}
+	{
+	} // connection_lease::connection_lease
+
+	connection_pool::connection_lease::~connection_lease()
+	{
+		if (!pool_) {
+			return;
+		}
+
+		try {
+			pool_->release(std::move(conn_), std::uncaught_exceptions() <= uncaught_exceptions_);
+		}
+		catch (...) {
+			// Releasing a connection must never throw from a destructor.
+		}
+	} // connection_lease::~connection_lease
+
+	auto connection_pool::connection_lease::get() noexcept -> nanodbc::connection&
+	{
+		return conn_;
+	} // connection_lease::get
+
+	connection_pool::connection_pool(connection_factory _factory, connection_pool_options _options)
+		: factory_{std::move(_factory)}
+		, options_{std::move(_options)}
+	{
+		idle_.reserve(options_.max_size);
+	} // connection_pool::connection_pool
+
+	auto connection_pool::acquire() -> connection_lease
+	{
+		{
+			std::scoped_lock lock{mutex_};
+
+			const auto now = clock_type::now();
+
+			// Connections are returned to the back of the list, so the front holds the
+			// connections which have been idle the longest.
+			const auto expired = std::find_if(std::begin(idle_), std::end(idle_), [this, now](const auto& _ic) {
+				return now - _ic.last_used < options_.idle_timeout;
+			});
+			connections_discarded_ += static_cast<std::uint64_t>(std::distance(std::begin(idle_), expired));
+			idle_.erase(std::begin(idle_), expired);
+
+			while (!idle_.empty()) {
+				auto ic = std::move(idle_.back());
+				idle_.pop_back();
+
+				if (is_healthy(ic, now)) {
+					++connections_reused_;
+					return {*this, std::move(ic.conn)};
+				}
+
+				++connections_discarded_;
+			}
+		}
+
+		// Connect without holding the lock. This is the expensive operation the pool exists to avoid.
+		auto conn = factory_();
+
+		std::scoped_lock lock{mutex_};
+		++connections_created_;
+
+		return {*this, std::move(conn)};
+	} // connection_pool::acquire
+
+	auto connection_pool::statistics() const -> connection_pool_statistics
+	{
+		std::scoped_lock lock{mutex_};
+
+		return {.connections_created = connections_created_,
+		        .connections_reused = connections_reused_,
+		        .connections_discarded = connections_discarded_,
+		        .idle_connections = idle_.size()};
+	} // connection_pool::statistics
+
+	auto connection_pool::release(nanodbc::connection _conn, bool _healthy) -> void
+	{
+		std::scoped_lock lock{mutex_};
+
+		if (!_healthy || !_conn.connected() || idle_.size() >= options_.max_size) {
+			++connections_discarded_;
+			return;
+		}
+
+		idle_.push_back({std::move(_conn), clock_type::now()});
+	} // connection_pool::release
+
+	auto connection_pool::is_healthy(idle_connection& _ic, clock_type::time_point _now) -> bool
+	{
+		if (!_ic.conn.connected()) {
+			return false;
+		}
+
+		// Recently used connections are trusted. This keeps the health check from adding a
+		// round trip to every request.
+		if (_now - _ic.last_used < options_.health_check_interval || options_.health_check_query.empty()) {
+			return true;
+		}
+
+		try {
+			nanodbc::just_execute(_ic.conn, options_.health_check_query);
+			return true;
+		}
+		catch (const nanodbc::database_error&) {
+			return false;
+		}
+	} // connection_pool::is_healthy
+} // namespace irods::experimental::genquery2
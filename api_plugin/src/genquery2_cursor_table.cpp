@@ -0,0 +1,76 @@
+#include "irods/plugins/api/private/genquery2_cursor_table.hpp"
+
+#include <fmt/format.h>
+
+#include <iterator>
+
+namespace irods::experimental::genquery2
+{
+	cursor_table::cursor_table(std::size_t _max_size, std::chrono::seconds _idle_timeout)
+		: max_size_{_max_size}
+		, idle_timeout_{_idle_timeout}
+		, rng_{std::random_device{}()}
+	{
+	} // cursor_table::cursor_table
+
+	auto cursor_table::full() const noexcept -> bool
+	{
+		return cursors_.size() >= max_size_;
+	} // cursor_table::full
+
+	auto cursor_table::insert(std::unique_ptr<cursor> _cursor) -> std::string
+	{
+		auto token = generate_token();
+
+		// Collisions are extremely unlikely, but they must never hand one client's cursor to another request.
+		while (cursors_.find(token) != std::end(cursors_)) {
+			token = generate_token();
+		}
+
+		_cursor->last_used = cursor::clock_type::now();
+		cursors_.emplace(token, std::move(_cursor));
+
+		return token;
+	} // cursor_table::insert
+
+	auto cursor_table::find(const std::string& _token) -> cursor*
+	{
+		const auto iter = cursors_.find(_token);
+
+		if (iter == std::end(cursors_)) {
+			return nullptr;
+		}
+
+		iter->second->last_used = cursor::clock_type::now();
+
+		return iter->second.get();
+	} // cursor_table::find
+
+	auto cursor_table::erase(const std::string& _token) -> void
+	{
+		cursors_.erase(_token);
+	} // cursor_table::erase
+
+	auto cursor_table::erase_expired() -> std::size_t
+	{
+		const auto now = cursor::clock_type::now();
+		std::size_t count = 0;
+
+		for (auto iter = std::begin(cursors_); iter != std::end(cursors_);) {
+			if (now - iter->second->last_used >= idle_timeout_) {
+				iter = cursors_.erase(iter);
+				++count;
+			}
+			else {
+				++iter;
+			}
+		}
+
+		return count;
+	} // cursor_table::erase_expired
+
+	auto cursor_table::generate_token() -> std::string
+	{
+		return fmt::format("{:016x}{:016x}", rng_(), rng_());
+	} // cursor_table::generate_token
+} // namespace irods::experimental::genquery2
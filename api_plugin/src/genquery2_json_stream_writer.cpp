@@ -0,0 +1,174 @@
+#include "irods/plugins/api/private/genquery2_json_stream_writer.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+
+namespace
+{
+	// Returns the length of the valid UTF-8 sequence starting at _p, or zero if the bytes do
+	// not form a valid sequence. _p must point to a byte greater than 0x7F.
+	auto utf8_sequence_length(const unsigned char* _p, const unsigned char* _end) noexcept -> std::size_t
+	{
+		const auto remaining = static_cast<std::size_t>(_end - _p);
+		const auto is_continuation = [](unsigned char _c) { return (_c & 0xC0) == 0x80; };
+
+		// The ranges follow the table of well-formed byte sequences in RFC 3629.
+		if (_p[0] >= 0xC2 && _p[0] <= 0xDF) {
+			return (remaining >= 2 && is_continuation(_p[1])) ? 2 : 0;
+		}
+
+		if (_p[0] >= 0xE0 && _p[0] <= 0xEF) {
+			if (remaining < 3 || !is_continuation(_p[1]) || !is_continuation(_p[2])) {
+				return 0;
+			}
+
+			// Reject overlong encodings and surrogates.
+			if ((_p[0] == 0xE0 && _p[1] < 0xA0) || (_p[0] == 0xED && _p[1] > 0x9F)) {
+				return 0;
+			}
+
+			return 3;
+		}
+
+		if (_p[0] >= 0xF0 && _p[0] <= 0xF4) {
+			if (remaining < 4 || !is_continuation(_p[1]) || !is_continuation(_p[2]) || !is_continuation(_p[3])) {
+				return 0;
+			}
+
+			// Reject overlong encodings and code points above U+10FFFF.
+			if ((_p[0] == 0xF0 && _p[1] < 0x90) || (_p[0] == 0xF4 && _p[1] > 0x8F)) {
+				return 0;
+			}
+
+			return 4;
+		}
+
+		return 0;
+	} // utf8_sequence_length
+} // anonymous namespace
+
+namespace irods::experimental::genquery2
+{
+	json_stream_writer::json_stream_writer(std::size_t _initial_capacity)
+	{
+		reserve(_initial_capacity);
+	} // json_stream_writer::json_stream_writer
+
+	json_stream_writer::~json_stream_writer()
+	{
+		std::free(data_); // NOLINT(cppcoreguidelines-owning-memory, cppcoreguidelines-no-malloc)
+	} // json_stream_writer::~json_stream_writer
+
+	auto json_stream_writer::raw(std::string_view _s) -> void
+	{
+		reserve(_s.size());
+		std::memcpy(data_ + size_, _s.data(), _s.size());
+		size_ += _s.size();
+	} // json_stream_writer::raw
+
+	auto json_stream_writer::string(std::string_view _s) -> void
+	{
+		// Most values require no escaping, so space for the common case is reserved up front.
+		reserve(_s.size() + 2);
+		data_[size_++] = '"';
+
+		const auto* p = reinterpret_cast<const unsigned char*>(_s.data()); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+		const auto* end = p + _s.size();
+		const auto* run = p;
+
+		// Bytes which do not need escaping are copied in runs rather than one at a time.
+		const auto flush = [this, &run](const unsigned char* _up_to) {
+			raw({reinterpret_cast<const char*>(run), static_cast<std::size_t>(_up_to - run)}); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+		};
+
+		while (p < end) {
+			if (*p >= 0x20 && *p < 0x80 && *p != '"' && *p != '\\') {
+				++p;
+				continue;
+			}
+
+			if (*p >= 0x80) {
+				if (const auto n = utf8_sequence_length(p, end); n > 0) {
+					p += n;
+					continue;
+				}
+
+				flush(p);
+				raw("\xEF\xBF\xBD");
+			}
+			else {
+				flush(p);
+				append_escaped(*p);
+			}
+
+			run = ++p;
+		}
+
+		flush(p);
+		raw("\"");
+	} // json_stream_writer::string
+
+	auto json_stream_writer::size() const noexcept -> std::size_t
+	{
+		return size_;
+	} // json_stream_writer::size
+
+	auto json_stream_writer::truncate(std::size_t _size) noexcept -> void
+	{
+		size_ = std::min(_size, size_);
+	} // json_stream_writer::truncate
+
+	auto json_stream_writer::release() -> char*
+	{
+		reserve(0);
+		data_[size_] = '\0';
+
+		size_ = 0;
+		capacity_ = 0;
+
+		return std::exchange(data_, nullptr);
+	} // json_stream_writer::release
+
+	auto json_stream_writer::reserve(std::size_t _n) -> void
+	{
+		if (data_ && size_ + _n < capacity_) {
+			return;
+		}
+
+		// Growing geometrically keeps the number of reallocations logarithmic in the size
+		// of the document.
+		const auto capacity = std::max(capacity_ * 2, size_ + _n + 1);
+
+		// NOLINTNEXTLINE(cppcoreguidelines-owning-memory, cppcoreguidelines-no-malloc)
+		auto* data = static_cast<char*>(std::realloc(data_, capacity));
+
+		if (!data) {
+			throw std::bad_alloc{};
+		}
+
+		data_ = data;
+		capacity_ = capacity;
+	} // json_stream_writer::reserve
+
+	auto json_stream_writer::append_escaped(unsigned char _c) -> void
+	{
+		switch (_c) {
+			case '"': raw("\\\""); return;
+			case '\\': raw("\\\\"); return;
+			case '\b': raw("\\b"); return;
+			case '\f': raw("\\f"); return;
+			case '\n': raw("\\n"); return;
+			case '\r': raw("\\r"); return;
+			case '\t': raw("\\t"); return;
+			default: break;
+		}
+
+		// Other control characters are written as \u00XX, matching nlohmann::json.
+		constexpr const char* hex = "0123456789abcdef";
+		const char escaped[] = {'\\', 'u', '0', '0', hex[_c >> 4], hex[_c & 0xF]};
+		raw({escaped, sizeof(escaped)});
+	} // json_stream_writer::append_escaped
+} // namespace irods::experimental::genquery2
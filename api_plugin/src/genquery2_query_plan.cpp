@@ -0,0 +1,209 @@
+#include "irods/plugins/api/private/genquery2_query_plan.hpp"
+
+#include <irods/irods_at_scope_exit.hpp>
+
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+	auto bind_values(nanodbc::statement& _stmt, const std::vector<std::string>& _values) -> void
+	{
+		for (std::vector<std::string>::size_type i = 0; i < _values.size(); ++i) {
+			_stmt.bind(static_cast<short>(i), _values.at(i).c_str());
+		}
+	} // bind_values
+
+	auto read_rows(nanodbc::result& _result) -> std::string
+	{
+		std::string plan;
+		const std::string null_value;
+
+		while (_result.next()) {
+			if (!plan.empty()) {
+				plan += '\n';
+			}
+
+			for (short i = 0; i < _result.columns(); ++i) {
+				if (i > 0) {
+					plan += " | ";
+				}
+
+				plan += _result.get<std::string>(i, null_value);
+			}
+		}
+
+		return plan;
+	} // read_rows
+
+	// Converts the output of read_rows into a JSON array of lines.
+	auto to_json_lines(std::string_view _plan) -> std::string
+	{
+		auto lines = nlohmann::json::array();
+
+		for (std::string_view::size_type pos = 0; pos < _plan.size();) {
+			const auto end = std::min(_plan.find('\n', pos), _plan.size());
+			lines.push_back(_plan.substr(pos, end - pos));
+			pos = end + 1;
+		}
+
+		return lines.dump();
+	} // to_json_lines
+} // anonymous namespace
+
+namespace irods::experimental::genquery2
+{
+	auto explain(nanodbc::connection& _conn,
+	             std::string_view _database,
+	             const std::string& _sql,
+	             const std::vector<std::string>& _values) -> std::string
+	{
+		if (_database == "oracle") {
+			// Oracle stores the plan in PLAN_TABLE rather than returning it. Bind variables
+			// are accepted and treated as strings.
+			nanodbc::statement stmt{_conn};
+			nanodbc::prepare(stmt, fmt::format("explain plan for {}", _sql));
+			bind_values(stmt, _values);
+			nanodbc::execute(stmt);
+
+			auto result = nanodbc::execute(_conn, "select plan_table_output from table(dbms_xplan.display())");
+			return read_rows(result);
+		}
+
+		if (_database != "postgres" && _database != "mysql") {
+			throw std::invalid_argument{fmt::format("Cannot explain queries for database [{}].", _database)};
+		}
+
+		nanodbc::statement stmt{_conn};
+		nanodbc::prepare(stmt, fmt::format("explain {}", _sql));
+		bind_values(stmt, _values);
+
+		auto result = nanodbc::execute(stmt);
+		return read_rows(result);
+	} // explain
+
+	auto explain_json(nanodbc::statement& _stmt,
+	                  std::string_view _database,
+	                  const std::string& _sql,
+	                  const std::vector<std::string>& _values,
+	                  bool _analyze) -> std::string
+	{
+		auto& conn = _stmt.connection();
+
+		if (_database == "postgres") {
+			nanodbc::prepare(_stmt,
+			                 fmt::format("explain ({}format json) {}", _analyze ? "analyze, buffers, " : "", _sql));
+			bind_values(_stmt, _values);
+
+			auto result = nanodbc::execute(_stmt);
+			return read_rows(result);
+		}
+
+		if (_database == "mysql") {
+			// EXPLAIN ANALYZE only supports the tree format.
+			if (_analyze) {
+				nanodbc::prepare(_stmt, fmt::format("explain analyze {}", _sql));
+				bind_values(_stmt, _values);
+
+				auto result = nanodbc::execute(_stmt);
+				return to_json_lines(read_rows(result));
+			}
+
+			nanodbc::prepare(_stmt, fmt::format("explain format=json {}", _sql));
+			bind_values(_stmt, _values);
+
+			auto result = nanodbc::execute(_stmt);
+			return read_rows(result);
+		}
+
+		if (_database == "oracle") {
+			if (!_analyze) {
+				return to_json_lines(explain(conn, _database, _sql, _values));
+			}
+
+			// The actual row counts and timings are only collected if the session asks for them.
+			// DBMS_XPLAN.DISPLAY_CURSOR then reports the last statement executed by the session.
+			// The connection is returned to the pool afterwards, so the setting is restored.
+			nanodbc::just_execute(conn, "alter session set statistics_level = all");
+			irods::at_scope_exit restore_statistics_level{[&conn] {
+				try {
+					nanodbc::just_execute(conn, "alter session set statistics_level = typical");
+				}
+				catch (...) {
+				}
+			}};
+
+			nanodbc::prepare(_stmt, _sql);
+			bind_values(_stmt, _values);
+
+			{
+				// The rows are read so that the statistics cover the whole statement.
+				auto result = nanodbc::execute(_stmt);
+
+				while (result.next()) {
+				}
+			}
+
+			auto result = nanodbc::execute(
+				conn, "select plan_table_output from table(dbms_xplan.display_cursor(null, null, 'ALLSTATS LAST'))");
+			return to_json_lines(read_rows(result));
+		}
+
+		throw std::invalid_argument{fmt::format("Cannot explain queries for database [{}].", _database)};
+	} // explain_json
+
+	auto estimate(nanodbc::connection& _conn,
+	              std::string_view _database,
+	              const std::string& _sql,
+	              const std::vector<std::string>& _values) -> plan_estimate
+	{
+		using json = nlohmann::json;
+
+		nanodbc::statement stmt{_conn};
+
+		if (_database == "postgres") {
+			nanodbc::prepare(stmt, fmt::format("explain (format json) {}", _sql));
+			bind_values(stmt, _values);
+
+			auto result = nanodbc::execute(stmt);
+			const auto plan = json::parse(read_rows(result)).at(0).at("Plan");
+
+			return {plan.at("Total Cost").get<double>(), plan.at("Plan Rows").get<double>()};
+		}
+
+		if (_database == "mysql") {
+			nanodbc::prepare(stmt, fmt::format("explain format=json {}", _sql));
+			bind_values(stmt, _values);
+
+			// MySQL reports the cost as a string and does not estimate the size of the result.
+			auto result = nanodbc::execute(stmt);
+			const auto plan = json::parse(read_rows(result));
+
+			return {std::stod(plan.at("query_block").at("cost_info").at("query_cost").get<std::string>())};
+		}
+
+		if (_database == "oracle") {
+			nanodbc::prepare(stmt, fmt::format("explain plan for {}", _sql));
+			bind_values(stmt, _values);
+			nanodbc::execute(stmt);
+
+			// The row with an ID of zero describes the statement as a whole. PLAN_TABLE is private
+			// to the session, so the most recent plan is the one just explained.
+			auto result = nanodbc::execute(
+				_conn,
+				"select cost, cardinality from plan_table "
+				"where id = 0 and plan_id = (select max(plan_id) from plan_table)");
+
+			if (!result.next()) {
+				throw std::runtime_error{"Oracle did not produce a plan."};
+			}
+
+			return {result.get<double>(0, 0.0), result.get<double>(1, -1.0)};
+		}
+
+		throw std::invalid_argument{fmt::format("Cannot estimate queries for database [{}].", _database)};
+	} // estimate
+} // namespace irods::experimental::genquery2
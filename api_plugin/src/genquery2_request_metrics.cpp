@@ -0,0 +1,60 @@
+#include "irods/plugins/api/private/genquery2_request_metrics.hpp"
+
+#include <irods/irods_logger.hpp>
+
+#include <fmt/format.h>
+
+#include <string>
+
+namespace
+{
+	namespace gq2 = irods::experimental::genquery2;
+
+	using log_api = irods::experimental::log::api;
+
+	auto to_microseconds(gq2::request_metrics::duration _d) -> long long
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(_d).count();
+	} // to_microseconds
+} // anonymous namespace
+
+namespace irods::experimental::genquery2
+{
+	auto request_metrics::finish(std::size_t _bytes) -> void
+	{
+		total = clock_type::now() - start;
+		bytes = _bytes;
+	} // request_metrics::finish
+
+	auto to_json(const request_metrics& _metrics) -> std::string
+	{
+		return fmt::format(R"({{"parse_us":{},"to_sql_us":{},"prepare_us":{},"execute_us":{},)"
+		                   R"("fetch_us":{},"serialize_us":{},"total_us":{},"rows":{},"bytes":{}}})",
+		                   to_microseconds(_metrics.parse),
+		                   to_microseconds(_metrics.to_sql),
+		                   to_microseconds(_metrics.prepare),
+		                   to_microseconds(_metrics.execute),
+		                   to_microseconds(_metrics.fetch),
+		                   to_microseconds(_metrics.serialize),
+		                   to_microseconds(_metrics.total),
+		                   _metrics.rows,
+		                   _metrics.bytes);
+	} // to_json
+
+	auto log_request_metrics(const request_metrics& _metrics, std::string_view _query_string) -> void
+	{
+		log_api::info({{"log_message", "GenQuery2 request metrics."},
+		               {"query_string", std::string{_query_string}},
+		               {"parse_us", std::to_string(to_microseconds(_metrics.parse))},
+		               {"to_sql_us", std::to_string(to_microseconds(_metrics.to_sql))},
+		               {"prepare_us", std::to_string(to_microseconds(_metrics.prepare))},
+		               {"execute_us", std::to_string(to_microseconds(_metrics.execute))},
+		               {"fetch_us", std::to_string(to_microseconds(_metrics.fetch))},
+		               {"serialize_us", std::to_string(to_microseconds(_metrics.serialize))},
+		               {"total_us", std::to_string(to_microseconds(_metrics.total))},
+		               {"rows", std::to_string(_metrics.rows)},
+		               {"bytes", std::to_string(_metrics.bytes)},
+		               {"fingerprint", fmt::format("{:016x}", _metrics.fingerprint)},
+		               {"error_code", std::to_string(_metrics.error_code)}});
+	} // log_request_metrics
+} // namespace irods::experimental::genquery2
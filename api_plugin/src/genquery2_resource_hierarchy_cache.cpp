@@ -0,0 +1,98 @@
+#include "irods/plugins/api/private/genquery2_resource_hierarchy_cache.hpp"
+
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace irods::experimental::genquery2
+{
+	auto build_resource_hierarchies(const std::vector<resource_row>& _rows)
+		-> irods::experimental::api::genquery::resource_hierarchy_map
+	{
+		std::unordered_map<std::string_view, const resource_row*> rows_by_id;
+		rows_by_id.reserve(_rows.size());
+
+		for (auto&& r : _rows) {
+			rows_by_id.emplace(r.id, &r);
+		}
+
+		irods::experimental::api::genquery::resource_hierarchy_map hierarchies;
+		hierarchies.reserve(_rows.size());
+
+		for (auto&& r : _rows) {
+			std::string hierarchy = r.name;
+			const auto* current = &r;
+
+			// The depth of a valid tree is bounded by the number of resources. Stopping there
+			// guards against cycles in a damaged catalog.
+			for (std::size_t depth = 0; !current->parent_id.empty() && depth < _rows.size(); ++depth) {
+				const auto iter = rows_by_id.find(current->parent_id);
+
+				if (iter == std::end(rows_by_id)) {
+					break;
+				}
+
+				current = iter->second;
+				hierarchy.insert(0, 1, ';');
+				hierarchy.insert(0, current->name);
+			}
+
+			hierarchies.insert_or_assign(r.id, std::move(hierarchy));
+		}
+
+		return hierarchies;
+	} // build_resource_hierarchies
+
+	resource_hierarchy_cache::resource_hierarchy_cache(loader _load, std::chrono::seconds _ttl)
+		: load_{std::move(_load)}
+		, ttl_{_ttl}
+	{
+	} // resource_hierarchy_cache::resource_hierarchy_cache
+
+	auto resource_hierarchy_cache::get(std::optional<std::uint64_t> _catalog_generation)
+		-> std::shared_ptr<const resource_hierarchy_snapshot>
+	{
+		std::scoped_lock lock{mutex_};
+
+		const auto now = clock_type::now();
+
+		// An unknown generation (i.e. the result cache is locked or disabled) is not treated as
+		// a change.
+		const auto catalog_changed = _catalog_generation && _catalog_generation != catalog_generation_;
+
+		if (snapshot_ && !snapshot_->stale && !catalog_changed && now - loaded_at_ < ttl_) {
+			return snapshot_;
+		}
+
+		auto hierarchies = build_resource_hierarchies(load_());
+
+		// Keeping the version when nothing changed keeps the translations which depend on it
+		// valid.
+		if (snapshot_ && snapshot_->hierarchies == hierarchies) {
+			snapshot_->stale = false;
+		}
+		else {
+			auto snapshot = std::make_shared<resource_hierarchy_snapshot>();
+			snapshot->version = ++last_version_;
+			snapshot->hierarchies = std::move(hierarchies);
+			snapshot_ = std::move(snapshot);
+		}
+
+		loaded_at_ = now;
+
+		if (_catalog_generation) {
+			catalog_generation_ = _catalog_generation;
+		}
+
+		return snapshot_;
+	} // resource_hierarchy_cache::get
+
+	auto resource_hierarchy_cache::invalidate() -> void
+	{
+		std::scoped_lock lock{mutex_};
+
+		if (snapshot_) {
+			snapshot_->stale = true;
+		}
+	} // resource_hierarchy_cache::invalidate
+} // namespace irods::experimental::genquery2
@@ -0,0 +1,259 @@
+#include "irods/plugins/api/private/genquery2_result_cache.hpp"
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/interprocess/allocators/allocator.hpp>
+#include <boost/interprocess/containers/map.hpp>
+#include <boost/interprocess/containers/string.hpp>
+#include <boost/interprocess/sync/interprocess_mutex.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+namespace
+{
+	namespace bip = boost::interprocess;
+
+	using segment_manager = bip::managed_shared_memory::segment_manager;
+	using char_allocator = bip::allocator<char, segment_manager>;
+	using shm_string = bip::basic_string<char, std::char_traits<char>, char_allocator>;
+
+	// The name of the shared memory segment. Every agent on the host attaches to it.
+	constexpr const char* segment_name = "irods_genquery2_result_cache";
+
+	// How long an agent waits for the mutex of the segment before bypassing the cache.
+	constexpr auto lock_timeout = boost::posix_time::milliseconds(100);
+
+	struct cache_entry
+	{
+		cache_entry(std::string_view _key,
+		            std::string_view _value,
+		            std::int64_t _expires_at,
+		            std::uint64_t _generation,
+		            const char_allocator& _allocator)
+			: key{_key.data(), _key.size(), _allocator}
+			, value{_value.data(), _value.size(), _allocator}
+			, expires_at{_expires_at}
+			, generation{_generation}
+		{
+		}
+
+		// Entries are mapped by the hash of their key. The key is kept to detect collisions.
+		shm_string key;
+		shm_string value;
+
+		// In nanoseconds since the epoch of the steady clock, which is shared by all processes.
+		std::int64_t expires_at;
+
+		std::uint64_t generation;
+	}; // struct cache_entry
+
+	template <typename Key, typename Value>
+	using shm_map = bip::map<Key, Value, std::less<Key>, bip::allocator<std::pair<const Key, Value>, segment_manager>>;
+
+	auto now() noexcept -> std::int64_t
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+		    .count();
+	} // now
+
+	auto hash(std::string_view _s) noexcept -> std::uint64_t
+	{
+		return std::hash<std::string_view>{}(_s);
+	} // hash
+
+	auto lock_deadline() -> boost::posix_time::ptime
+	{
+		return boost::posix_time::microsec_clock::universal_time() + lock_timeout;
+	} // lock_deadline
+
+	auto is_identifier_char(char _c) noexcept -> bool
+	{
+		return (_c >= 'A' && _c <= 'Z') || (_c >= 'a' && _c <= 'z') || (_c >= '0' && _c <= '9') || _c == '_';
+	} // is_identifier_char
+} // anonymous namespace
+
+namespace irods::experimental::genquery2
+{
+	struct result_cache::segment_data
+	{
+		explicit segment_data(segment_manager* _segment_manager)
+			: entries{_segment_manager}
+			, versions{_segment_manager}
+		{
+		}
+
+		bip::interprocess_mutex mutex;
+
+		// Maps the hash of a key to its entry.
+		shm_map<std::uint64_t, cache_entry> entries;
+
+		// Maps the hash of a table name to its version.
+		shm_map<std::uint64_t, std::uint64_t> versions;
+	}; // struct result_cache::segment_data
+
+	auto referenced_tables(std::string_view _sql) -> std::vector<std::string>
+	{
+		std::vector<std::string> tables;
+
+		for (std::string_view::size_type pos = 0; (pos = _sql.find("R_", pos)) != std::string_view::npos;) {
+			// The name must not be the tail of another identifier (e.g. an alias).
+			if (pos > 0 && is_identifier_char(_sql[pos - 1])) {
+				pos += 2;
+				continue;
+			}
+
+			auto end = pos + 2;
+
+			while (end < _sql.size() && is_identifier_char(_sql[end])) {
+				++end;
+			}
+
+			tables.emplace_back(_sql.substr(pos, end - pos));
+			pos = end;
+		}
+
+		std::sort(std::begin(tables), std::end(tables));
+		tables.erase(std::unique(std::begin(tables), std::end(tables)), std::end(tables));
+
+		return tables;
+	} // referenced_tables
+
+	result_cache::result_cache(std::size_t _size_in_bytes, std::chrono::seconds _ttl)
+		: segment_{bip::open_or_create, segment_name, _size_in_bytes}
+		, data_{segment_.find_or_construct<segment_data>("data")(segment_.get_segment_manager())}
+		, ttl_{_ttl}
+	{
+	} // result_cache::result_cache
+
+	auto result_cache::find(std::string_view _key, const std::vector<std::string>& _tables) -> result_cache_lookup
+	{
+		bip::scoped_lock<bip::interprocess_mutex> lock{data_->mutex, lock_deadline()};
+
+		if (!lock) {
+			return {};
+		}
+
+		const auto generation = generation_of(_tables);
+
+		result_cache_lookup result;
+		result.generation = generation;
+
+		const auto iter = data_->entries.find(hash(_key));
+
+		if (iter == std::end(data_->entries)) {
+			return result;
+		}
+
+		const auto& entry = iter->second;
+
+		if (entry.expires_at <= now() || entry.generation != generation) {
+			data_->entries.erase(iter);
+			return result;
+		}
+
+		if (std::string_view{entry.key.data(), entry.key.size()} == _key) {
+			result.value.emplace(entry.value.data(), entry.value.size());
+		}
+
+		return result;
+	} // result_cache::find
+
+	auto result_cache::insert(std::string_view _key, std::uint64_t _generation, std::string_view _value) -> void
+	{
+		bip::scoped_lock<bip::interprocess_mutex> lock{data_->mutex, lock_deadline()};
+
+		if (!lock) {
+			return;
+		}
+
+		auto& entries = data_->entries;
+		const auto key_hash = hash(_key);
+		const auto expires_at = now() + std::chrono::duration_cast<std::chrono::nanoseconds>(ttl_).count();
+
+		const auto try_insert = [&] {
+			entries.erase(key_hash);
+			entries.emplace(
+				key_hash,
+				cache_entry{_key, _value, expires_at, _generation, char_allocator{segment_.get_segment_manager()}});
+		};
+
+		try {
+			try_insert();
+			return;
+		}
+		catch (const bip::bad_alloc&) {
+		}
+
+		const auto t = now();
+
+		for (auto iter = std::begin(entries); iter != std::end(entries);) {
+			iter = (iter->second.expires_at <= t) ? entries.erase(iter) : std::next(iter);
+		}
+
+		try {
+			try_insert();
+			return;
+		}
+		catch (const bip::bad_alloc&) {
+		}
+
+		entries.clear();
+
+		try {
+			try_insert();
+		}
+		catch (const bip::bad_alloc&) {
+			// The value does not fit even into an empty segment.
+		}
+	} // result_cache::insert
+
+	auto result_cache::generation(const std::vector<std::string>& _tables) -> std::optional<std::uint64_t>
+	{
+		bip::scoped_lock<bip::interprocess_mutex> lock{data_->mutex, lock_deadline()};
+
+		if (!lock) {
+			return std::nullopt;
+		}
+
+		return generation_of(_tables);
+	} // result_cache::generation
+
+	auto result_cache::invalidate(const std::vector<std::string>& _tables) -> bool
+	{
+		bip::scoped_lock<bip::interprocess_mutex> lock{data_->mutex, lock_deadline()};
+
+		if (!lock) {
+			return false;
+		}
+
+		for (auto&& t : _tables) {
+			const auto table_hash = hash(t);
+
+			try {
+				++data_->versions[table_hash];
+			}
+			catch (const bip::bad_alloc&) {
+				// Cached results are expendable. The versions are not.
+				data_->entries.clear();
+				++data_->versions[table_hash];
+			}
+		}
+
+		return true;
+	} // result_cache::invalidate
+
+	auto result_cache::generation_of(const std::vector<std::string>& _tables) const -> std::uint64_t
+	{
+		std::uint64_t generation = 0;
+
+		for (auto&& t : _tables) {
+			if (const auto iter = data_->versions.find(hash(t)); iter != std::end(data_->versions)) {
+				generation += iter->second;
+			}
+		}
+
+		return generation;
+	} // result_cache::generation_of
+} // namespace irods::experimental::genquery2
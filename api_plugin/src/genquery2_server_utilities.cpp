@@ -0,0 +1,656 @@
+#include "irods/plugins/api/private/genquery2_server_utilities.hpp"
+#include "irods/plugins/api/genquery2_common.h" // For GENQUERY2_QUERY_COST_EXCEEDED.
+#include "irods/plugins/api/private/genquery2_query_plan.hpp"
+
+#include "irods/genquery2_driver.hpp"
+#include "irods/genquery2_fingerprint.hpp"
+
+#include <irods/base64.h>
+#include <irods/catalog.hpp> // Requires linking against libnanodbc.so
+#include <irods/irods_logger.hpp>
+#include <irods/irods_server_properties.hpp>
+#include <irods/irods_version.h>
+#include <irods/rodsConnect.h>
+#include <irods/rodsDef.h>
+#include <irods/rodsErrorTable.h>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace
+{
+	namespace gq2 = irods::experimental::genquery2;
+
+	using log_api = irods::experimental::log::api;
+	using json = nlohmann::json;
+
+	// Produces the name and native type of each column selected by a GenQuery2 string.
+	class result_column_visitor
+	{
+	  public:
+		auto operator()(const gq::column& _column) const -> gq2::result_column;
+
+		auto operator()(const gq::select_function& _select_function) const -> gq2::result_column;
+	}; // class result_column_visitor
+
+	//
+	// Function Prototypes
+	//
+
+	auto load_plugin_configuration() -> gq2::plugin_configuration;
+
+	auto describe_columns(const gq::select& _select) -> std::vector<gq2::result_column>;
+
+	auto next_row(gq2::bulk_result& _result, gq2::request_metrics* _metrics) -> bool;
+
+	auto load_resources() -> std::vector<gq2::resource_row>;
+
+	// Returns nullptr if the hierarchies are not available.
+	auto current_resource_hierarchies() -> std::shared_ptr<const gq2::resource_hierarchy_snapshot>;
+
+	//
+	// Function Implementations
+	//
+
+	auto result_column_visitor::operator()(const gq::column& _column) const -> gq2::result_column
+	{
+		// The type produced by a cast depends on the database, so it is treated as a string.
+		if (!_column.type_name.empty()) {
+			return {fmt::format("cast({} as {})", _column.name, _column.type_name)};
+		}
+
+		const auto iter = gq::column_name_mappings.find(_column.name);
+		const auto type = (iter != std::end(gq::column_name_mappings)) ? iter->second.type : gq::column_type::string;
+
+		return {_column.name, type};
+	} // result_column_visitor::operator()
+
+	auto result_column_visitor::operator()(const gq::select_function& _select_function) const
+		-> gq2::result_column
+	{
+		const auto column = (*this)(_select_function.column);
+		auto name = fmt::format("{}({})", _select_function.name, column.name);
+
+		if (boost::iequals(_select_function.name, "count")) {
+			return {std::move(name), gq::column_type::integer};
+		}
+
+		// Other aggregate functions (e.g. avg) may produce values of a different type than
+		// the column, so only these are known to preserve it.
+		if (boost::iequals(_select_function.name, "min") || boost::iequals(_select_function.name, "max")) {
+			return {std::move(name), column.type};
+		}
+
+		return {std::move(name)};
+	} // result_column_visitor::operator()
+
+	auto load_plugin_configuration() -> gq2::plugin_configuration
+	{
+#if IRODS_VERSION_INTEGER < 4003001
+		const auto& config = irods::server_properties::instance().map();
+#else
+		const auto handle = irods::server_properties::instance().map();
+		const auto& config = handle.get_json();
+#endif
+
+		gq2::plugin_configuration pc;
+
+		// Get the database type string from server_config.json.
+		const auto& db = config.at(json::json_pointer{"/plugin_configuration/database"});
+		pc.database = std::begin(db).key();
+
+		const auto gq2_config = config.value(json::json_pointer{"/plugin_configuration/api/genquery2"}, json::object());
+		pc.translation_cache_size = gq2_config.value("translation_cache_size", pc.translation_cache_size);
+
+		auto& cp = pc.connection_pool;
+		cp.max_size = gq2_config.value("connection_pool_size", cp.max_size);
+		cp.idle_timeout = std::chrono::seconds{
+			gq2_config.value("connection_idle_timeout_in_seconds", cp.idle_timeout.count())};
+		cp.health_check_interval = std::chrono::seconds{
+			gq2_config.value("connection_health_check_interval_in_seconds", cp.health_check_interval.count())};
+
+		if (pc.database == "oracle") {
+			cp.health_check_query = "select 1 from dual";
+		}
+
+		pc.max_open_cursors = gq2_config.value("max_open_cursors", pc.max_open_cursors);
+		pc.cursor_idle_timeout =
+			std::chrono::seconds{gq2_config.value("cursor_idle_timeout_in_seconds", pc.cursor_idle_timeout.count())};
+		pc.fetch_batch_size = gq2_config.value("fetch_batch_size", pc.fetch_batch_size);
+		pc.log_request_metrics = gq2_config.value("log_request_metrics", pc.log_request_metrics);
+		pc.slow_query_threshold = std::chrono::milliseconds{
+			gq2_config.value("slow_query_threshold_in_milliseconds", pc.slow_query_threshold.count())};
+		pc.slow_query_log_bind_values = gq2_config.value("slow_query_log_bind_values", pc.slow_query_log_bind_values);
+		pc.statement_timeout = std::chrono::seconds{
+			gq2_config.value("statement_timeout_in_seconds", pc.statement_timeout.count())};
+		pc.max_statement_timeout = std::chrono::seconds{
+			gq2_config.value("max_statement_timeout_in_seconds", pc.max_statement_timeout.count())};
+		pc.cancel_on_client_disconnect =
+			gq2_config.value("cancel_on_client_disconnect", pc.cancel_on_client_disconnect);
+		pc.max_response_bytes = gq2_config.value("max_response_bytes", pc.max_response_bytes);
+		pc.result_cache_size_in_bytes = gq2_config.value("result_cache_size_in_bytes", pc.result_cache_size_in_bytes);
+		pc.result_cache_ttl =
+			std::chrono::seconds{gq2_config.value("result_cache_ttl_in_seconds", pc.result_cache_ttl.count())};
+		pc.result_cache_max_entry_bytes =
+			gq2_config.value("result_cache_max_entry_bytes", pc.result_cache_max_entry_bytes);
+		pc.resource_hierarchy_cache_ttl = std::chrono::seconds{gq2_config.value(
+			"resource_hierarchy_cache_ttl_in_seconds", pc.resource_hierarchy_cache_ttl.count())};
+		pc.zones_use_byte_order_collation =
+			gq2_config.value("zones_use_byte_order_collation", pc.zones_use_byte_order_collation);
+
+		for (auto&& [user_type, threshold] : gq2_config.value("admission_control", json::object()).items()) {
+			pc.admission_thresholds.insert_or_assign(user_type, gq2::to_admission_threshold(threshold));
+		}
+
+		return pc;
+	} // load_plugin_configuration
+
+	auto describe_columns(const gq::select& _select) -> std::vector<gq2::result_column>
+	{
+		std::vector<gq2::result_column> columns;
+		columns.reserve(_select.selections.size());
+
+		const result_column_visitor v;
+
+		for (auto&& s : _select.selections) {
+			columns.push_back(std::visit(v, s));
+		}
+
+		return columns;
+	} // describe_columns
+
+	auto next_row(gq2::bulk_result& _result, gq2::request_metrics* _metrics) -> bool
+	{
+		const gq2::phase_timer timer{_metrics, &gq2::request_metrics::fetch};
+		return _result.next();
+	} // next_row
+
+	auto load_resources() -> std::vector<gq2::resource_row>
+	{
+		auto conn = gq2::get_connection_pool().acquire();
+		auto result =
+			nanodbc::execute(conn.get(), "select resc_id, resc_name, resc_parent from R_RESC_MAIN where resc_id > 0");
+
+		std::vector<gq2::resource_row> rows;
+
+		while (result.next()) {
+			// Oracle stores the empty parent of a root resource as null.
+			rows.push_back({result.get<std::string>(0), result.get<std::string>(1), result.get<std::string>(2, "")});
+		}
+
+		log_api::trace("Loaded the hierarchies of [{}] resources.", rows.size());
+
+		return rows;
+	} // load_resources
+
+	auto current_resource_hierarchies() -> std::shared_ptr<const gq2::resource_hierarchy_snapshot>
+	{
+		auto* cache = gq2::get_resource_hierarchy_cache();
+
+		if (!cache) {
+			return nullptr;
+		}
+
+		// Lets an invalidation of R_RESC_MAIN by any agent on the host refresh the hierarchies.
+		std::optional<std::uint64_t> catalog_generation;
+
+		if (auto* result_cache = gq2::get_result_cache(); result_cache) {
+			catalog_generation = result_cache->generation({"R_RESC_MAIN"});
+		}
+
+		try {
+			return cache->get(catalog_generation);
+		}
+		catch (const std::exception& e) {
+			// The database can still produce the hierarchies itself.
+			log_api::error("Could not load resource hierarchies. Continuing without them: {}", e.what());
+			return nullptr;
+		}
+	} // current_resource_hierarchies
+} // anonymous namespace
+
+namespace irods::experimental::genquery2
+{
+	auto get_plugin_configuration() -> const plugin_configuration&
+	{
+		// The configuration is read once per agent.
+		static const auto config = load_plugin_configuration();
+		return config;
+	} // get_plugin_configuration
+
+	auto get_translation_cache() -> translation_cache&
+	{
+		static translation_cache cache{get_plugin_configuration().translation_cache_size};
+		return cache;
+	} // get_translation_cache
+
+	auto get_connection_pool() -> connection_pool&
+	{
+		const auto connect = [] {
+			auto [db_inst, db_conn] = irods::experimental::catalog::new_database_connection();
+			return db_conn;
+		};
+
+		static connection_pool pool{connect, get_plugin_configuration().connection_pool};
+		return pool;
+	} // get_connection_pool
+
+	auto get_result_cache() -> result_cache*
+	{
+		static const auto cache = []() -> std::unique_ptr<result_cache> {
+			const auto& config = get_plugin_configuration();
+
+			if (0 == config.result_cache_size_in_bytes) {
+				return nullptr;
+			}
+
+			try {
+				return std::make_unique<result_cache>(config.result_cache_size_in_bytes, config.result_cache_ttl);
+			}
+			catch (const std::exception& e) {
+				log_api::error("Could not open GenQuery2 result cache. Continuing without it: {}", e.what());
+				return nullptr;
+			}
+		}();
+
+		return cache.get();
+	} // get_result_cache
+
+	auto get_resource_hierarchy_cache() -> resource_hierarchy_cache*
+	{
+		static const auto cache = []() -> std::unique_ptr<resource_hierarchy_cache> {
+			const auto ttl = get_plugin_configuration().resource_hierarchy_cache_ttl;
+
+			if (ttl.count() <= 0) {
+				return nullptr;
+			}
+
+			return std::make_unique<resource_hierarchy_cache>(load_resources, ttl);
+		}();
+
+		return cache.get();
+	} // get_resource_hierarchy_cache
+
+	auto log_connection_pool_statistics() -> void
+	{
+		const auto stats = get_connection_pool().statistics();
+		log_api::trace("GenQuery2 connection pool: created=[{}], reused=[{}], discarded=[{}], idle=[{}]",
+		               stats.connections_created,
+		               stats.connections_reused,
+		               stats.connections_discarded,
+		               stats.idle_connections);
+	} // log_connection_pool_statistics
+
+	auto resolve_catalog_provider(RsComm* _comm, const char* _zone, rodsServerHost** _host_info) -> int
+	{
+		// If the client did not provide a zone, getAndConnRcatHost() will operate as if the
+		// client provided the local zone's name.
+		if (const auto ec = getAndConnRcatHost(_comm, PRIMARY_RCAT, _zone, _host_info); ec < 0) {
+			log_api::error("Could not connect to remote zone [{}].", _zone);
+			return ec;
+		}
+
+		// Return an error if the host information does not point to the zone of interest.
+		// getAndConnRcatHost() returns the local zone if the target zone does not exist. We must catch
+		// this situation to avoid querying the wrong catalog.
+		if (*_host_info && _zone) {
+			const std::string_view resolved_zone = static_cast<zoneInfo*>((*_host_info)->zoneInfo)->zoneName;
+
+			if (resolved_zone != _zone) {
+				log_api::error("Could not find zone [{}].", _zone);
+				return SYS_INVALID_ZONE_NAME;
+			}
+		}
+
+		return 0;
+	} // resolve_catalog_provider
+
+	auto translate(std::string_view _query_string, const gq::options& _opts, request_metrics* _metrics)
+		-> translation
+	{
+		auto& cache = get_translation_cache();
+
+		// Avoids consulting the resource hierarchy cache for the queries which cannot use it.
+		const auto resource_hierarchies = (_query_string.find("DATA_RESC_HIER") != std::string_view::npos)
+		                                      ? current_resource_hierarchies()
+		                                      : nullptr;
+
+		auto opts = _opts;
+		opts.resource_hierarchies = resource_hierarchies ? &resource_hierarchies->hierarchies : nullptr;
+
+		translation_key key{
+			.query_string = std::string{_query_string},
+			.database = std::string{opts.database},
+			.default_number_of_rows = opts.default_number_of_rows,
+			.max_number_of_rows = opts.max_number_of_rows,
+			.admin_mode = opts.admin_mode,
+			.count_only = opts.count_only,
+			.resource_hierarchy_version = resource_hierarchies ? resource_hierarchies->version : 0};
+
+		auto t = cache.find(key);
+
+		if (t) {
+			for (auto pos : t->username_value_positions) {
+				t->values.at(pos) = opts.username;
+			}
+		}
+		else {
+			// Reused across requests so that the agent allocates the buffers of the parser once.
+			thread_local driver d;
+
+			{
+				const phase_timer timer{_metrics, &request_metrics::parse};
+
+				if (const auto ec = d.parse(_query_string); ec != 0) {
+					throw std::invalid_argument{fmt::format("Failed to parse GenQuery2 string. [error code=[{}]]", ec)};
+				}
+			}
+
+			auto normalized_query = gq::normalize(d.select);
+			const auto fingerprint = gq::fingerprint(normalized_query);
+
+			const phase_timer timer{_metrics, &request_metrics::to_sql};
+
+			auto [sql, values, username_value_positions, resource_hierarchy_columns] = gq::to_sql(d.select, opts);
+			t = translation{std::move(sql),
+			                std::move(values),
+			                std::move(username_value_positions),
+			                describe_columns(d.select),
+			                std::move(resource_hierarchy_columns),
+			                std::move(normalized_query),
+			                fingerprint,
+			                nullptr};
+
+			// Empty SQL means the translation failed. Do not cache it.
+			if (!t->sql.empty()) {
+				cache.insert(std::move(key), *t);
+			}
+		}
+
+		const auto stats = cache.statistics();
+		log_api::trace("GenQuery2 translation cache: hits=[{}], misses=[{}], evictions=[{}], size=[{}], capacity=[{}]",
+		               stats.hits,
+		               stats.misses,
+		               stats.evictions,
+		               stats.size,
+		               stats.capacity);
+
+		log_api::trace("GenQuery2 query fingerprint: [{:016x}], normalized query: [{}]",
+		               t->fingerprint,
+		               t->normalized_query);
+
+		if (_metrics) {
+			_metrics->fingerprint = t->fingerprint;
+		}
+
+		if (!t->resource_hierarchy_columns.empty()) {
+			t->resource_hierarchies = resource_hierarchies;
+		}
+
+		return *t;
+	} // translate
+
+	auto apply_admission_control(RsComm* _comm,
+	                             std::string_view _query_string,
+	                             gq::options& _opts,
+	                             translation& _translation,
+	                             request_metrics* _metrics) -> int
+	{
+		const auto& config = get_plugin_configuration();
+		const auto iter = config.admission_thresholds.find(_comm->clientUser.userType);
+
+		if (iter == std::end(config.admission_thresholds)) {
+			return 0;
+		}
+
+		const auto& threshold = iter->second;
+		plan_estimate estimated;
+
+		try {
+			auto conn = get_connection_pool().acquire();
+			estimated = estimate(conn.get(), config.database, _translation.sql, _translation.values);
+		}
+		catch (const std::exception& e) {
+			// An estimate is not available for every query and database. Rejecting such queries
+			// would make the catalog unusable, so they are executed as is.
+			log_api::warn("Could not estimate the cost of GenQuery2 query. Skipping admission control: {}", e.what());
+			return 0;
+		}
+
+		log_api::trace("GenQuery2 plan estimate: cost=[{}], rows=[{}]", estimated.cost, estimated.rows);
+
+		switch (decide(threshold, estimated)) {
+			case admission_decision::admit:
+				return 0;
+
+			case admission_decision::reject:
+				log_api::error("GenQuery2 query rejected by admission control: estimated cost=[{}], estimated rows=[{}], "
+				               "user=[{}], user type=[{}]",
+				               estimated.cost,
+				               estimated.rows,
+				               _comm->clientUser.userName,
+				               _comm->clientUser.userType);
+				return GENQUERY2_QUERY_COST_EXCEEDED;
+
+			case admission_decision::limit:
+				log_api::info("GenQuery2 query limited to [{}] rows by admission control: estimated cost=[{}], "
+				              "estimated rows=[{}], user=[{}], user type=[{}]",
+				              threshold.row_limit,
+				              estimated.cost,
+				              estimated.rows,
+				              _comm->clientUser.userName,
+				              _comm->clientUser.userType);
+				_opts.max_number_of_rows = threshold.row_limit;
+				_translation = translate(_query_string, _opts, _metrics);
+				return 0;
+		}
+
+		return 0;
+	} // apply_admission_control
+
+	auto log_slow_query(std::string_view _query_string,
+	                    const translation& _translation,
+	                    const request_metrics& _metrics) -> void
+	{
+		const auto& config = get_plugin_configuration();
+
+		if (config.slow_query_threshold.count() <= 0 || _metrics.total < config.slow_query_threshold) {
+			return;
+		}
+
+		std::string plan;
+
+		try {
+			// The connection which executed the query may still have an open result set (i.e.
+			// cursors), so the plan is obtained via a different connection.
+			auto conn = get_connection_pool().acquire();
+			plan = explain(conn.get(), config.database, _translation.sql, _translation.values);
+		}
+		catch (const std::exception& e) {
+			plan = fmt::format("unavailable: {}", e.what());
+		}
+
+		const auto bind_values = config.slow_query_log_bind_values
+		                             ? nlohmann::json(_translation.values).dump()
+		                             : fmt::format("[{} value(s) omitted]", _translation.values.size());
+
+		log_api::warn({{"log_message", "GenQuery2 slow query."},
+		               {"query_string", std::string{_query_string}},
+		               {"fingerprint", fmt::format("{:016x}", _translation.fingerprint)},
+		               {"normalized_query", _translation.normalized_query},
+		               {"sql", _translation.sql},
+		               {"bind_values", bind_values},
+		               {"metrics", to_json(_metrics)},
+		               {"query_plan", plan}});
+	} // log_slow_query
+
+	auto statement_timeout(int _requested_seconds) -> std::chrono::seconds
+	{
+		const auto& config = get_plugin_configuration();
+
+		auto timeout = (_requested_seconds > 0) ? std::chrono::seconds{_requested_seconds} : config.statement_timeout;
+
+		if (config.max_statement_timeout.count() > 0 &&
+		    (timeout.count() <= 0 || timeout > config.max_statement_timeout)) {
+			timeout = config.max_statement_timeout;
+		}
+
+		return timeout;
+	} // statement_timeout
+
+	auto watched_client_socket(const RsComm& _comm) -> int
+	{
+		return get_plugin_configuration().cancel_on_client_disconnect ? _comm.sock : -1;
+	} // watched_client_socket
+
+	auto response_byte_budget(int _requested_bytes) -> std::size_t
+	{
+		const auto& config = get_plugin_configuration();
+
+		auto budget = (_requested_bytes > 0) ? static_cast<std::size_t>(_requested_bytes)
+		                                     : std::numeric_limits<std::size_t>::max();
+
+		if (config.max_response_bytes > 0) {
+			budget = std::min(budget, config.max_response_bytes);
+		}
+
+		return budget;
+	} // response_byte_budget
+
+	auto to_base64(std::string_view _bytes) -> std::string
+	{
+		// Four characters are produced for every three bytes, plus a null terminator.
+		unsigned long size = 4 * ((_bytes.size() + 2) / 3) + 1;
+		std::string encoded(size, '\0');
+
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+		if (const auto ec = base64_encode(reinterpret_cast<const unsigned char*>(_bytes.data()),
+		                                  _bytes.size(),
+		                                  reinterpret_cast<unsigned char*>(encoded.data()),
+		                                  &size);
+		    ec != 0)
+		{
+			throw std::runtime_error{fmt::format("Could not base64-encode result. [error code=[{}]]", ec)};
+		}
+
+		encoded.resize(size);
+
+		return encoded;
+	} // to_base64
+
+	auto execute(nanodbc::statement& _stmt,
+	             const translation& _translation,
+	             std::optional<bulk_result>& _result,
+	             request_metrics* _metrics) -> void
+	{
+		const auto requested = get_plugin_configuration().fetch_batch_size;
+
+		{
+			const phase_timer timer{_metrics, &request_metrics::execute};
+			_result.emplace(_stmt, requested);
+		}
+
+		if (!_translation.resource_hierarchy_columns.empty()) {
+			_result->resolve_resource_hierarchies(
+				_translation.resource_hierarchy_columns, _translation.resource_hierarchies, current_resource_hierarchies);
+		}
+
+		log_api::trace("GenQuery2 fetch batch size: requested=[{}], used=[{}]", requested, _result->batch_size());
+	} // execute
+
+	auto read_json_rows(bulk_result& _result,
+	                    bool _has_pending_row,
+	                    std::size_t _max_rows,
+	                    std::size_t _max_bytes,
+	                    json_stream_writer& _writer,
+	                    request_metrics* _metrics) -> bool
+	{
+		const serialize_timer timer{_metrics};
+
+		const auto n_cols = _result.columns();
+		const std::string null_value;
+
+		// Reused for every value so that reading a value does not allocate.
+		std::string value;
+		std::size_t n_rows = 0;
+
+		auto row_available = _has_pending_row || next_row(_result, _metrics);
+
+		const auto start = _writer.size();
+		_writer.raw("[");
+
+		while (row_available && n_rows < _max_rows && _writer.size() - start < _max_bytes) {
+			_writer.raw((n_rows == 0) ? "[" : ",[");
+
+			for (short i = 0; i < n_cols; ++i) {
+				if (i > 0) {
+					_writer.raw(",");
+				}
+
+				_result.get_ref(i, null_value, value);
+				_writer.string(value);
+			}
+
+			_writer.raw("]");
+			++n_rows;
+
+			row_available = next_row(_result, _metrics);
+		}
+
+		_writer.raw("]");
+
+		if (_metrics) {
+			_metrics->rows += n_rows;
+		}
+
+		// Fetching one row past the end tells us whether more rows exist.
+		return row_available;
+	} // read_json_rows
+
+	auto read_arrow_rows(bulk_result& _result,
+	                     bool _has_pending_row,
+	                     std::size_t _max_rows,
+	                     std::size_t _max_bytes,
+	                     arrow_stream_writer& _writer,
+	                     request_metrics* _metrics) -> bool
+	{
+		const serialize_timer timer{_metrics};
+
+		const auto n_cols = _result.columns();
+		const std::string null_value;
+		std::string value;
+		std::size_t n_bytes = 0;
+
+		auto row_available = _has_pending_row || next_row(_result, _metrics);
+
+		while (row_available && static_cast<std::size_t>(_writer.number_of_rows()) < _max_rows && n_bytes < _max_bytes) {
+			for (short i = 0; i < n_cols; ++i) {
+				if (_result.is_null(i)) {
+					_writer.append_null();
+				}
+				else {
+					_result.get_ref(i, null_value, value);
+					_writer.append(value);
+					n_bytes += value.size();
+				}
+			}
+
+			row_available = next_row(_result, _metrics);
+		}
+
+		if (_metrics) {
+			_metrics->rows += static_cast<std::size_t>(_writer.number_of_rows());
+		}
+
+		return row_available;
+	} // read_arrow_rows
+} // namespace irods::experimental::genquery2
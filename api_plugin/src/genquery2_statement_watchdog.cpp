@@ -0,0 +1,144 @@
+#include "irods/plugins/api/private/genquery2_statement_watchdog.hpp"
+
+#include "irods/plugins/api/genquery2_common.h"
+
+#include <irods/irods_logger.hpp>
+#include <irods/rodsErrorTable.h>
+
+#include <sql.h>
+
+#include <poll.h>
+
+#include <algorithm>
+
+namespace
+{
+	using log_api = irods::experimental::log::api;
+
+	// How often the client connection is checked while a statement is running.
+	constexpr std::chrono::milliseconds client_check_interval{250};
+
+	auto to_string(irods::experimental::genquery2::cancel_reason _reason) noexcept -> const char*
+	{
+		using irods::experimental::genquery2::cancel_reason;
+
+		switch (_reason) {
+			case cancel_reason::timeout:
+				return "Statement timed out.";
+			case cancel_reason::client_disconnected:
+				return "Client disconnected.";
+			case cancel_reason::none:
+				break;
+		}
+
+		return "Statement was not cancelled.";
+	} // to_string
+} // anonymous namespace
+
+namespace irods::experimental::genquery2
+{
+	statement_cancelled::statement_cancelled(cancel_reason _reason)
+		: std::runtime_error{to_string(_reason)}
+		, reason_{_reason}
+	{
+	} // statement_cancelled::statement_cancelled
+
+	auto statement_cancelled::error_code() const noexcept -> int
+	{
+		// Nobody receives the error of a client which went away, so it only needs to be an error.
+		return (cancel_reason::timeout == reason_) ? GENQUERY2_STATEMENT_TIMEOUT : SYS_SOCK_READ_ERR;
+	} // statement_cancelled::error_code
+
+	statement_watchdog::statement_watchdog(nanodbc::statement& _statement,
+	                                       int _client_socket,
+	                                       std::chrono::seconds _timeout)
+		: handle_{_statement.native_statement_handle()}
+		, client_socket_{_client_socket}
+	{
+		if (_timeout.count() <= 0 && client_socket_ < 0) {
+			return;
+		}
+
+		const auto deadline = (_timeout.count() > 0) ? std::chrono::steady_clock::now() + _timeout
+		                                              : std::chrono::steady_clock::time_point::max();
+
+		thread_ = std::thread{[this, deadline] { watch(deadline); }};
+	} // statement_watchdog::statement_watchdog
+
+	statement_watchdog::~statement_watchdog()
+	{
+		if (!thread_.joinable()) {
+			return;
+		}
+
+		{
+			std::lock_guard lock{mutex_};
+			stopped_ = true;
+		}
+
+		cv_.notify_one();
+		thread_.join();
+	} // statement_watchdog::~statement_watchdog
+
+	auto statement_watchdog::reason() const noexcept -> cancel_reason
+	{
+		return reason_.load();
+	} // statement_watchdog::reason
+
+	auto statement_watchdog::watch(std::chrono::steady_clock::time_point _deadline) -> void
+	{
+		std::unique_lock lock{mutex_};
+
+		while (!stopped_) {
+			const auto now = std::chrono::steady_clock::now();
+
+			if (now >= _deadline) {
+				cancel(cancel_reason::timeout);
+				return;
+			}
+
+			if (client_disconnected()) {
+				cancel(cancel_reason::client_disconnected);
+				return;
+			}
+
+			const auto wait_time =
+				(client_socket_ < 0) ? _deadline - now
+				                     : std::min<std::chrono::steady_clock::duration>(_deadline - now, client_check_interval);
+
+			cv_.wait_for(lock, wait_time, [this] { return stopped_; });
+		}
+	} // statement_watchdog::watch
+
+	auto statement_watchdog::client_disconnected() const noexcept -> bool
+	{
+		if (client_socket_ < 0) {
+			return false;
+		}
+
+		// The client does not send anything while it waits for the response, so the socket
+		// only becomes readable if the client closes its end of the connection.
+		pollfd pfd{};
+		pfd.fd = client_socket_;
+		pfd.events = POLLRDHUP;
+
+		if (poll(&pfd, 1, 0) <= 0) {
+			return false;
+		}
+
+		return (pfd.revents & (POLLRDHUP | POLLHUP | POLLERR)) != 0; // NOLINT(hicpp-signed-bitwise)
+	} // statement_watchdog::client_disconnected
+
+	auto statement_watchdog::cancel(cancel_reason _reason) -> void
+	{
+		// The reason is recorded first so that the failure caused by the cancellation is
+		// reported correctly by run().
+		reason_.store(_reason);
+
+		log_api::warn("Cancelling GenQuery2 statement: {}", to_string(_reason));
+
+		if (!SQL_SUCCEEDED(SQLCancel(handle_))) {
+			log_api::error("Could not cancel GenQuery2 statement.");
+		}
+	} // statement_watchdog::cancel
+} // namespace irods::experimental::genquery2
@@ -0,0 +1,78 @@
+#include "irods/plugins/api/private/genquery2_translation_cache.hpp"
+
+#include <functional>
+
+namespace irods::experimental::genquery2
+{
+	auto translation_cache::key_hash::operator()(const translation_key& _key) const noexcept -> std::size_t
+	{
+		// Combines the hashes using the same approach as boost::hash_combine.
+		const auto combine = [](std::size_t _seed, std::size_t _value) {
+			return _seed ^ (_value + 0x9e3779b9 + (_seed << 6) + (_seed >> 2));
+		};
+
+		auto seed = std::hash<std::string>{}(_key.query_string);
+		seed = combine(seed, std::hash<std::string>{}(_key.database));
+		seed = combine(seed, std::hash<std::uint16_t>{}(_key.default_number_of_rows));
+		seed = combine(seed, std::hash<std::uint64_t>{}(_key.max_number_of_rows));
+		seed = combine(seed, std::hash<bool>{}(_key.admin_mode));
+		seed = combine(seed, std::hash<bool>{}(_key.count_only));
+		return combine(seed, std::hash<std::uint64_t>{}(_key.resource_hierarchy_version));
+	} // translation_cache::key_hash::operator()
+
+	translation_cache::translation_cache(std::size_t _capacity)
+		: capacity_{_capacity}
+	{
+		index_.reserve(capacity_);
+	} // translation_cache::translation_cache
+
+	auto translation_cache::find(const translation_key& _key) -> std::optional<translation>
+	{
+		std::scoped_lock lock{mutex_};
+
+		const auto iter = index_.find(_key);
+
+		if (iter == std::end(index_)) {
+			++misses_;
+			return std::nullopt;
+		}
+
+		++hits_;
+
+		// Move the entry to the front of the list so that it is evicted last.
+		entries_.splice(std::begin(entries_), entries_, iter->second);
+
+		return iter->second->second;
+	} // translation_cache::find
+
+	auto translation_cache::insert(translation_key _key, translation _translation) -> void
+	{
+		std::scoped_lock lock{mutex_};
+
+		if (0 == capacity_) {
+			return;
+		}
+
+		if (const auto iter = index_.find(_key); iter != std::end(index_)) {
+			iter->second->second = std::move(_translation);
+			entries_.splice(std::begin(entries_), entries_, iter->second);
+			return;
+		}
+
+		if (entries_.size() >= capacity_) {
+			index_.erase(entries_.back().first);
+			entries_.pop_back();
+			++evictions_;
+		}
+
+		entries_.emplace_front(std::move(_key), std::move(_translation));
+		index_.emplace(entries_.front().first, std::begin(entries_));
+	} // translation_cache::insert
+
+	auto translation_cache::statistics() const -> translation_cache_statistics
+	{
+		std::scoped_lock lock{mutex_};
+
+		return {.hits = hits_, .misses = misses_, .evictions = evictions_, .size = entries_.size(), .capacity = capacity_};
+	} // translation_cache::statistics
+} // namespace irods::experimental::genquery2
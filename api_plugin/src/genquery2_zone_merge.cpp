@@ -0,0 +1,186 @@
+#include "irods/plugins/api/private/genquery2_zone_merge.hpp"
+
+#include "irods/genquery2_driver.hpp"
+#include "irods/table_column_key_maps.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <charconv>
+#include <queue>
+#include <stdexcept>
+#include <variant>
+
+namespace
+{
+	namespace gq = irods::experimental::api::genquery;
+	namespace gq2 = irods::experimental::genquery2;
+
+	// Identifies the next row of a zone which has not been written yet.
+	struct cursor_position
+	{
+		std::size_t result_index;
+		std::size_t row_index;
+	}; // struct cursor_position
+
+	auto compare_values(std::string_view _lhs, std::string_view _rhs, bool _numeric) noexcept -> int
+	{
+		if (_numeric) {
+			long long lhs = 0;
+			long long rhs = 0;
+
+			const auto [lhs_end, lhs_ec] = std::from_chars(_lhs.data(), _lhs.data() + _lhs.size(), lhs);
+			const auto [rhs_end, rhs_ec] = std::from_chars(_rhs.data(), _rhs.data() + _rhs.size(), rhs);
+
+			// NULL values are returned as empty strings. Those are compared as strings.
+			if (std::errc{} == lhs_ec && std::errc{} == rhs_ec) {
+				return (lhs < rhs) ? -1 : (lhs > rhs) ? 1 : 0;
+			}
+		}
+
+		return _lhs.compare(_rhs);
+	} // compare_values
+} // anonymous namespace
+
+namespace irods::experimental::genquery2
+{
+	auto make_merge_spec(std::string_view _query_string,
+	                     std::size_t _default_number_of_rows,
+	                     bool _byte_order_collation) -> merge_spec
+	{
+		driver d;
+
+		if (const auto ec = d.parse(_query_string); ec != 0) {
+			throw std::invalid_argument{fmt::format("Failed to parse GenQuery2 string. [error code=[{}]]", ec)};
+		}
+
+		// Each zone would skip its own first rows, which is not the same as skipping the first
+		// rows of the merged result.
+		if (!d.select.range.offset.empty()) {
+			throw std::invalid_argument{"OFFSET is not supported when querying multiple zones."};
+		}
+
+		merge_spec spec;
+		spec.limit = d.select.range.number_of_rows.empty() ? _default_number_of_rows
+		                                                   : std::stoull(d.select.range.number_of_rows);
+
+		for (auto&& se : d.select.order_by.sort_expressions) {
+			const auto& selections = d.select.selections;
+
+			// The columns in the order-by clause must exist in the list of columns to project.
+			const auto iter = std::find_if(std::begin(selections), std::end(selections), [&se](const gq::selection& _s) {
+				const auto* column = std::get_if<gq::column>(&_s);
+				return column && column->name == se.column;
+			});
+
+			if (iter == std::end(selections)) {
+				throw std::invalid_argument{
+					fmt::format("Sort column [{}] must be selected when querying multiple zones.", se.column)};
+			}
+
+			const auto& column = std::get<gq::column>(*iter);
+			const auto mapping = gq::column_name_mappings.find(column.name);
+			const auto numeric = column.type_name.empty() && mapping != std::end(gq::column_name_mappings) &&
+			                     mapping->second.type != gq::column_type::string;
+
+			// The rows are merged in byte order. If a zone sorted them differently, the merged
+			// rows would be out of order and the limit would drop the wrong ones.
+			if (!numeric && !_byte_order_collation) {
+				throw std::invalid_argument{fmt::format(
+					"Sort column [{}] is compared byte-wise when querying multiple zones, which requires every zone "
+					"to sort strings byte-wise (i.e. the \"C\" collation). Set zones_use_byte_order_collation if "
+					"this is the case.",
+					se.column)};
+			}
+
+			spec.sort_keys.push_back({static_cast<std::size_t>(std::distance(std::begin(selections), iter)),
+			                          se.ascending_order,
+			                          numeric});
+		}
+
+		return spec;
+	} // make_merge_spec
+
+	auto merge_zone_results(const std::vector<zone_result>& _results, const merge_spec& _spec, json_stream_writer& _writer)
+		-> void
+	{
+		const auto row_at = [&_results](const cursor_position& _p) -> const nlohmann::json& {
+			return _results[_p.result_index].rows[_p.row_index];
+		};
+
+		// Returns true if _lhs must be written after _rhs. Ties are broken by the order of the
+		// zones so that the output is deterministic.
+		const auto comes_after = [&](const cursor_position& _lhs, const cursor_position& _rhs) {
+			const auto& lhs = row_at(_lhs);
+			const auto& rhs = row_at(_rhs);
+
+			for (auto&& key : _spec.sort_keys) {
+				const auto& l = lhs.at(key.index).get_ref<const std::string&>();
+				const auto& r = rhs.at(key.index).get_ref<const std::string&>();
+
+				if (const auto c = compare_values(l, r, key.numeric); c != 0) {
+					return key.ascending ? c > 0 : c < 0;
+				}
+			}
+
+			return _lhs.result_index > _rhs.result_index;
+		};
+
+		std::priority_queue<cursor_position, std::vector<cursor_position>, decltype(comes_after)> queue{comes_after};
+
+		for (std::size_t i = 0; i < _results.size(); ++i) {
+			if (0 == _results[i].error_code && !_results[i].rows.empty()) {
+				queue.push({i, 0});
+			}
+		}
+
+		_writer.raw(R"({"rows":[)");
+
+		for (std::size_t n = 0; n < _spec.limit && !queue.empty(); ++n) {
+			// Without sort keys, every row of a zone compares equal to the rows of other zones,
+			// so the zones are written one after the other.
+			auto p = queue.top();
+			queue.pop();
+
+			if (n > 0) {
+				_writer.raw(",");
+			}
+
+			_writer.raw("[");
+			_writer.string(_results[p.result_index].zone);
+
+			for (auto&& value : row_at(p)) {
+				_writer.raw(",");
+				_writer.string(value.get_ref<const std::string&>());
+			}
+
+			_writer.raw("]");
+
+			if (++p.row_index < _results[p.result_index].rows.size()) {
+				queue.push(p);
+			}
+		}
+
+		_writer.raw(R"(],"errors":[)");
+
+		auto first = true;
+
+		for (auto&& r : _results) {
+			if (0 == r.error_code) {
+				continue;
+			}
+
+			if (!first) {
+				_writer.raw(",");
+			}
+
+			first = false;
+
+			_writer.raw(R"({"zone":)");
+			_writer.string(r.zone);
+			_writer.raw(fmt::format(R"(,"error_code":{}}})", r.error_code));
+		}
+
+		_writer.raw("]}");
+	} // merge_zone_results
+} // namespace irods::experimental::genquery2
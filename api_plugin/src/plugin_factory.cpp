@@ -35,14 +35,20 @@ extern "C" auto plugin_factory(
 #if IRODS_VERSION_INTEGER < 4003001
 		[](void* _p) {
 			auto* q = static_cast<genquery2_input*>(_p);
-			if (q->query_string) { std::free(q->query_string); }
-			if (q->zone)         { std::free(q->zone); }
+			if (q->query_string)       { std::free(q->query_string); }
+			if (q->zone)               { std::free(q->zone); }
+			if (q->continuation_token) { std::free(q->continuation_token); }
+			if (q->zones)              { std::free(q->zones); }
+			if (q->invalidate_tables)  { std::free(q->invalidate_tables); }
 		},
 #else
 		[](void* _p) {
 			auto* q = static_cast<genquery2_input*>(_p);
-			if (q->query_string) { std::free(q->query_string); }
-			if (q->zone)         { std::free(q->zone); }
+			if (q->query_string)       { std::free(q->query_string); }
+			if (q->zone)               { std::free(q->zone); }
+			if (q->continuation_token) { std::free(q->continuation_token); }
+			if (q->zones)              { std::free(q->zones); }
+			if (q->invalidate_tables)  { std::free(q->invalidate_tables); }
 		},
 		irods::clearOutStruct_noop,
 #endif
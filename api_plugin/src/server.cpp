@@ -1,34 +1,126 @@
 #include "irods/plugins/api/private/genquery2_common.hpp"
 #include "irods/plugins/api/genquery2_common.h" // For API plugin number.
+#include "irods/plugins/api/private/genquery2_compression.hpp"
+#include "irods/plugins/api/private/genquery2_cursor_table.hpp"
+#include "irods/plugins/api/private/genquery2_query_plan.hpp"
+#include "irods/plugins/api/private/genquery2_server_utilities.hpp"
+#include "irods/plugins/api/private/genquery2_statement_watchdog.hpp"
+#include "irods/plugins/api/private/genquery2_zone_merge.hpp"
 
-#include "irods/genquery2_driver.hpp"
 #include "irods/genquery2_sql.hpp"
 
 #include <irods/apiHandler.hpp>
-#include <irods/catalog.hpp> // Requires linking against libnanodbc.so
+#include <irods/irods_at_scope_exit.hpp>
 #include <irods/irods_logger.hpp>
 #include <irods/irods_rs_comm_query.hpp>
-#include <irods/irods_server_properties.hpp>
-#include <irods/irods_version.h>
 #include <irods/procApiRequest.h>
 #include <irods/rodsConnect.h>
-#include <irods/rodsDef.h>
 #include <irods/rodsErrorTable.h>
+#include <irods/rsGlobalExtern.hpp>
 
 #include <fmt/format.h>
 #include <nanodbc/nanodbc.h>
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
 #include <cstring> // For strdup.
+#include <future>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace
 {
+	namespace gq = irods::experimental::api::genquery;
+	namespace gq2 = irods::experimental::genquery2;
+
 	using log_api = irods::experimental::log::api;
 
 	//
 	// Function Prototypes
 	//
 
+	auto get_cursor_table() -> gq2::cursor_table&;
+
+	auto read_page(gq2::cursor& _cursor,
+	               std::size_t _max_rows,
+	               std::size_t _max_bytes,
+	               gq2::json_stream_writer& _writer,
+	               gq2::request_metrics* _metrics) -> void;
+
+	auto end_page_response(gq2::json_stream_writer& _writer, const std::string* _continuation_token) -> char*;
+
+	auto metrics_enabled(const genquery2_input* _input) -> bool;
+
+	// Logs the metrics and, if the request was slow, the query of _translation. The metrics are
+	// appended to the response if _include_metrics is true.
+	auto report_metrics(std::string_view _query_string,
+	                    const gq2::translation* _translation,
+	                    gq2::request_metrics* _metrics,
+	                    bool _include_metrics,
+	                    gq2::json_stream_writer& _writer) -> void;
+
+	// Returns the plan of the translated query instead of its rows.
+	auto explain_query(RsComm* _comm,
+	                   const genquery2_input* _input,
+	                   const gq2::translation& _translation,
+	                   char** _output) -> int;
+
+	auto open_cursor(RsComm* _comm,
+	                 const genquery2_input* _input,
+	                 const gq2::translation& _translation,
+	                 gq2::request_metrics* _metrics,
+	                 char** _output) -> int;
+
+	auto read_next_page(RsComm* _comm,
+	                    const genquery2_input* _input,
+	                    gq2::request_metrics* _metrics,
+	                    char** _output) -> int;
+
+	// Returns true if the response to _input only depends on the rows produced by the query,
+	// which allows it to be served from the result cache.
+	auto is_result_cacheable(const genquery2_input* _input) -> bool;
+
+	// Identifies the result of a translated query. The bind values hold the name of the user
+	// for queries subject to permissions, which keeps users from seeing each other's results.
+	auto make_result_cache_key(const gq2::translation& _translation) -> std::string;
+
+	// Discards the cached results of queries reading the tables listed in _tables. The
+	// resource hierarchies of the agent are discarded as well if R_RESC_MAIN is listed.
+	// Only administrators may do this, and only for the tables GenQuery2 reads.
+	auto invalidate_result_cache(RsComm* _comm, std::string_view _tables) -> int;
+
+	// Executes the request on the local catalog service provider.
+	auto execute_locally(RsComm* _comm, const genquery2_input* _input, char** _output) -> int;
+
+	// Does the work of execute_locally. _metrics may be null.
+	auto execute_request(RsComm* _comm, const genquery2_input* _input, gq2::request_metrics* _metrics, char** _output)
+		-> int;
+
+	// Replaces the output with its compressed form if the client asked for it.
+	auto compress_output(const genquery2_input* _input, char** _output) -> int;
+
+	// Returns the non-empty elements of a comma-separated list, without duplicates. Spaces
+	// surrounding an element are removed.
+	auto split_list(std::string_view _list) -> std::vector<std::string>;
+
+	// Returns the names of the zones listed in _zones, without duplicates. "*" lists every
+	// zone known to the server.
+	auto list_zones(std::string_view _zones) -> std::vector<std::string>;
+
+	// Stores the response of one zone in _result. Takes ownership of _output.
+	auto store_zone_output(gq2::zone_result& _result, int _ec, char* _output) -> void;
+
+	// Executes the query in every zone listed in genquery2_input::zones concurrently and
+	// merges the results.
+	auto execute_across_zones(RsComm* _comm, const genquery2_input* _input, char** _output) -> int;
+
 	auto call_genquery2(irods::api_entry*, RsComm*, const genquery2_input*, char**) -> int;
 
 	auto rs_genquery2(RsComm*, const genquery2_input*, char**) -> int;
@@ -37,95 +129,356 @@ namespace
 	// Function Implementations
 	//
 
-	auto call_genquery2(irods::api_entry* _api, RsComm* _comm, const genquery2_input* _input, char** _output) -> int
+	auto get_cursor_table() -> gq2::cursor_table&
 	{
-		return _api->call_handler<const genquery2_input*, char**>(_comm, _input, _output);
-	} // call_genquery2
-
-	auto rs_genquery2(RsComm* _comm, const genquery2_input* _input, char** _output) -> int
+		// Cursors hold connections leased from the pool. Constructing the pool first guarantees
+		// it is destroyed after the cursor table when the agent shuts down.
+		gq2::get_connection_pool();
+
+		const auto& config = gq2::get_plugin_configuration();
+		static gq2::cursor_table cursors{config.max_open_cursors, config.cursor_idle_timeout};
+		return cursors;
+	} // get_cursor_table
+
+	auto read_page(gq2::cursor& _cursor,
+	               std::size_t _max_rows,
+	               std::size_t _max_bytes,
+	               gq2::json_stream_writer& _writer,
+	               gq2::request_metrics* _metrics) -> void
 	{
-		if (!_input || !_input->query_string || !_output) {
-			log_api::error("Invalid input: received nullptr for message pointer and/or response pointer.");
-			return SYS_INVALID_INPUT_PARAM;
+		// The page response is {"rows": ..., "continuation_token": ...}. See end_page_response.
+		_writer.raw(R"({"rows":)");
+
+		if (GENQUERY2_OUTPUT_FORMAT_ARROW == _cursor.output_format) {
+			gq2::arrow_stream_writer arrow_writer{_cursor.query.columns};
+			_cursor.has_pending_row = gq2::read_arrow_rows(
+				*_cursor.result, _cursor.has_pending_row, _max_rows, _max_bytes, arrow_writer, _metrics);
+
+			const gq2::phase_timer timer{_metrics, &gq2::request_metrics::serialize};
+			_writer.string(gq2::to_base64(arrow_writer.finish()));
+			return;
 		}
 
-		// Redirect to the catalog service provider based on the user-provided zone.
-		// This allows clients to query federated zones.
-		//
-		// If the client did not provide a zone, getAndConnRcatHost() will operate as if the
-		// client provided the local zone's name.
-		if (_input->zone) {
-			log_api::trace(
-				"GenQuery2 API endpoint received: query_string=[{}], zone=[{}]", _input->query_string, _input->zone);
+		_cursor.has_pending_row =
+			gq2::read_json_rows(*_cursor.result, _cursor.has_pending_row, _max_rows, _max_bytes, _writer, _metrics);
+	} // read_page
+
+	auto end_page_response(gq2::json_stream_writer& _writer, const std::string* _continuation_token) -> char*
+	{
+		_writer.raw(R"(,"continuation_token":)");
+
+		if (_continuation_token) {
+			_writer.string(*_continuation_token);
 		}
 		else {
-			log_api::trace("GenQuery2 API endpoint received: query_string=[{}], zone=[nullptr]", _input->query_string);
+			_writer.raw("null");
 		}
 
-		rodsServerHost* host_info{};
+		_writer.raw("}");
 
-		if (const auto ec = getAndConnRcatHost(_comm, PRIMARY_RCAT, _input->zone, &host_info); ec < 0) {
-			log_api::error("Could not connect to remote zone [{}].", _input->zone);
-			return ec;
+		return _writer.release();
+	} // end_page_response
+
+	auto metrics_enabled(const genquery2_input* _input) -> bool
+	{
+		const auto& config = gq2::get_plugin_configuration();
+		return _input->include_metrics != 0 || config.log_request_metrics || config.slow_query_threshold.count() > 0;
+	} // metrics_enabled
+
+	auto report_metrics(std::string_view _query_string,
+	                    const gq2::translation* _translation,
+	                    gq2::request_metrics* _metrics,
+	                    bool _include_metrics,
+	                    gq2::json_stream_writer& _writer) -> void
+	{
+		if (!_metrics) {
+			return;
+		}
+
+		_metrics->finish(_writer.size());
+
+		if (gq2::get_plugin_configuration().log_request_metrics) {
+			gq2::log_request_metrics(*_metrics, _query_string);
+		}
+
+		if (_translation) {
+			gq2::log_slow_query(_query_string, *_translation, *_metrics);
 		}
 
-		// Return an error if the host information does not point to the zone of interest.
-		// getAndConnRcatHost() returns the local zone if the target zone does not exist. We must catch
-		// this situation to avoid querying the wrong catalog.
-		if (host_info && _input->zone) {
-			const std::string_view resolved_zone = static_cast<zoneInfo*>(host_info->zoneInfo)->zoneName;
+		// The caller is responsible for wrapping the rows in an object.
+		if (_include_metrics) {
+			_writer.raw(R"(,"metrics":)");
+			_writer.raw(gq2::to_json(*_metrics));
+		}
+	} // report_metrics
+
+	auto explain_query(RsComm* _comm,
+	                   const genquery2_input* _input,
+	                   const gq2::translation& _translation,
+	                   char** _output) -> int
+	{
+		const auto analyze = GENQUERY2_EXPLAIN_ANALYZE == _input->explain;
+
+		// Analyzing a query executes it, which bypasses admission control and the response size
+		// limit.
+		if (analyze && !irods::is_privileged_client(*_comm)) {
+			log_api::error("GenQuery2 explain analyze is only available to administrators.");
+			return CAT_INSUFFICIENT_PRIVILEGE_LEVEL;
+		}
+
+		const auto& config = gq2::get_plugin_configuration();
+		auto conn = gq2::get_connection_pool().acquire();
+		nanodbc::statement stmt{conn.get()};
+
+		// Analyzing a query executes it, so it is subject to the timeout like any other query.
+		gq2::statement_watchdog watchdog{
+			stmt, gq2::watched_client_socket(*_comm), gq2::statement_timeout(_input->timeout_in_seconds)};
+		const auto plan = watchdog.run(
+			[&] { return gq2::explain_json(stmt, config.database, _translation.sql, _translation.values, analyze); });
+
+		gq2::json_stream_writer writer;
+		writer.raw(R"({"sql":)");
+		writer.string(_translation.sql);
+		writer.raw(R"(,"plan":)");
+		writer.raw(plan);
+		writer.raw("}");
+
+		*_output = writer.release();
+
+		return 0;
+	} // explain_query
+
+	auto open_cursor(RsComm* _comm,
+	                 const genquery2_input* _input,
+	                 const gq2::translation& _translation,
+	                 gq2::request_metrics* _metrics,
+	                 char** _output) -> int
+	{
+		auto& cursors = get_cursor_table();
+
+		if (cursors.full()) {
+			log_api::error("Could not open GenQuery2 cursor: the maximum number of open cursors has been reached.");
+			return SYS_OUT_OF_FILE_DESC;
+		}
+
+		auto c = std::make_unique<gq2::cursor>(gq2::get_connection_pool().acquire());
+		c->username = _comm->clientUser.userName;
+		c->page_size = static_cast<std::size_t>(_input->page_size);
+		c->max_page_bytes = gq2::response_byte_budget(_input->max_response_bytes);
+		c->output_format = _input->output_format;
+		c->query_string = _input->query_string;
+		c->query = _translation;
+
+		{
+			const gq2::phase_timer timer{_metrics, &gq2::request_metrics::prepare};
+
+			nanodbc::prepare(c->statement, c->query.sql);
 
-			if (resolved_zone != _input->zone) {
-				log_api::error("Could not find zone [{}].", _input->zone);
-				return SYS_INVALID_ZONE_NAME;
+			const auto& values = c->query.values;
+
+			for (std::vector<std::string>::size_type i = 0; i < values.size(); ++i) {
+				c->statement.bind(static_cast<short>(i), values.at(i).c_str());
 			}
 		}
 
-		if (host_info->localFlag != LOCAL_HOST) {
-			log_api::trace("Redirecting request to remote zone [{}].", _input->zone);
+		gq2::json_stream_writer writer;
 
-			return procApiRequest(
-				host_info->conn,
-				IRODS_APN_GENQUERY2,
-				_input,
-				nullptr,
-				reinterpret_cast<void**>(_output), // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-				nullptr);
+		{
+			// The timeout covers the execution of the query and the first page.
+			gq2::statement_watchdog watchdog{
+				c->statement, gq2::watched_client_socket(*_comm), gq2::statement_timeout(_input->timeout_in_seconds)};
+
+			watchdog.run([&] {
+				gq2::execute(c->statement, c->query, c->result, _metrics);
+				read_page(*c, c->page_size, c->max_page_bytes, writer, _metrics);
+			});
 		}
 
-		//
-		// At this point, we assume we're connected to the catalog service provider.
-		//
+		report_metrics(c->query_string, &c->query, _metrics, _input->include_metrics != 0, writer);
 
-		try {
-			using json = nlohmann::json;
+		// Only keep the cursor open if there is something left to read.
+		if (!c->has_pending_row) {
+			*_output = end_page_response(writer, nullptr);
+			return 0;
+		}
 
-			gq::options opts;
+		const auto token = cursors.insert(std::move(c));
+		log_api::trace("Opened GenQuery2 cursor [{}].", token);
 
+		*_output = end_page_response(writer, &token);
+
+		return 0;
+	} // open_cursor
+
+	auto read_next_page(RsComm* _comm,
+	                    const genquery2_input* _input,
+	                    gq2::request_metrics* _metrics,
+	                    char** _output) -> int
+	{
+		auto& cursors = get_cursor_table();
+		const std::string token = _input->continuation_token;
+		auto* c = cursors.find(token);
+
+		if (!c || c->username != _comm->clientUser.userName) {
+			log_api::error("Continuation token [{}] does not refer to an open GenQuery2 cursor.", token);
+			return SYS_INVALID_INPUT_PARAM;
+		}
+
+		// The cursor is closed when the last page is read or if reading the page fails. Erasing
+		// the cursor while an exception is propagating also keeps its connection out of the pool.
+		auto keep_cursor = false;
+		irods::at_scope_exit close_cursor{[&cursors, &token, &keep_cursor] {
+			if (!keep_cursor) {
+				cursors.erase(token);
+				log_api::trace("Closed GenQuery2 cursor [{}].", token);
+			}
+		}};
+
+		const auto page_size = (_input->page_size > 0) ? static_cast<std::size_t>(_input->page_size) : c->page_size;
+		const auto max_page_bytes =
+			(_input->max_response_bytes > 0) ? gq2::response_byte_budget(_input->max_response_bytes) : c->max_page_bytes;
+		gq2::json_stream_writer writer;
+
+		{
+			gq2::statement_watchdog watchdog{
+				c->statement, gq2::watched_client_socket(*_comm), gq2::statement_timeout(_input->timeout_in_seconds)};
+			watchdog.run([&] { read_page(*c, page_size, max_page_bytes, writer, _metrics); });
+		}
+
+		report_metrics(c->query_string, &c->query, _metrics, _input->include_metrics != 0, writer);
+
+		keep_cursor = c->has_pending_row;
+
+		*_output = end_page_response(writer, keep_cursor ? &token : nullptr);
+
+		return 0;
+	} // read_next_page
+
+	auto is_result_cacheable(const genquery2_input* _input) -> bool
+	{
+		return 0 == _input->include_metrics && 0 == _input->max_response_bytes &&
+		       GENQUERY2_OUTPUT_FORMAT_JSON == _input->output_format;
+	} // is_result_cacheable
+
+	auto make_result_cache_key(const gq2::translation& _translation) -> std::string
+	{
+		// Neither the SQL nor the bind values can contain a null character.
+		auto key = _translation.sql;
+
+		for (auto&& v : _translation.values) {
+			key += '\0';
+			key += v;
+		}
+
+		return key;
+	} // make_result_cache_key
+
+	auto invalidate_result_cache(RsComm* _comm, std::string_view _tables) -> int
+	{
+		// Invalidating the caches makes every agent on the host read the catalog again, so
+		// only administrators are allowed to do it.
+		if (!irods::is_privileged_client(*_comm)) {
+			log_api::error("Only administrators may invalidate the GenQuery2 caches.");
+			return CAT_INSUFFICIENT_PRIVILEGE_LEVEL;
+		}
+
+		const auto tables = split_list(_tables);
+
+		if (const auto iter = std::find_if_not(std::begin(tables), std::end(tables), gq::is_catalog_table);
+		    iter != std::end(tables))
+		{
+			log_api::error("Invalid input: [{}] is not a catalog table.", *iter);
+			return SYS_INVALID_INPUT_PARAM;
+		}
+
+		// Other agents notice the invalidation via the result cache, if it is enabled.
+		if (auto* hierarchies = gq2::get_resource_hierarchy_cache();
+		    hierarchies && std::find(std::begin(tables), std::end(tables), "R_RESC_MAIN") != std::end(tables))
+		{
+			hierarchies->invalidate();
+		}
+
+		auto* cache = gq2::get_result_cache();
+
+		if (!cache) {
+			return 0;
+		}
+
+		if (!cache->invalidate(tables)) {
+			log_api::error("Could not invalidate GenQuery2 result cache: the cache is locked.");
+			return SYS_INTERNAL_ERR;
+		}
+
+		log_api::trace("Invalidated GenQuery2 result cache for tables [{}].", _tables);
+
+		return 0;
+	} // invalidate_result_cache
+
+	auto execute_locally(RsComm* _comm, const genquery2_input* _input, char** _output) -> int
+	{
+		// Metrics are only collected if they will be used. Otherwise, no time is spent reading
+		// the clock.
+		std::optional<gq2::request_metrics> metrics;
+
+		if (metrics_enabled(_input)) {
+			metrics.emplace();
+		}
+
+		auto ec = 0;
+
+		// Failed requests (e.g. those which timed out) never reach report_metrics, yet they are
+		// the ones operators most need to see. A finished request has already been reported.
+		irods::at_scope_exit log_failed_request{[&ec, &metrics, _input] {
+			if (ec >= 0 || !metrics || metrics->total != gq2::request_metrics::duration{} ||
+			    !gq2::get_plugin_configuration().log_request_metrics)
 			{
-				// Get the database type string from server_config.json.
-#if IRODS_VERSION_INTEGER < 4003001
-				const auto& config = irods::server_properties::instance().map();
-#else
-				const auto handle = irods::server_properties::instance().map();
-				const auto& config = handle.get_json();
-#endif
-				const auto& db = config.at(json::json_pointer{"/plugin_configuration/database"});
-				opts.database = std::begin(db).key();
+				return;
+			}
+
+			metrics->finish(0);
+			metrics->error_code = ec;
+			gq2::log_request_metrics(*metrics, _input->query_string ? _input->query_string : "");
+		}};
+
+		ec = execute_request(_comm, _input, metrics ? &*metrics : nullptr, _output);
+
+		return ec;
+	} // execute_locally
+
+	auto execute_request(RsComm* _comm, const genquery2_input* _input, gq2::request_metrics* _metrics, char** _output)
+		-> int
+	{
+		try {
+			auto* m = _metrics;
+
+			if (const auto n = get_cursor_table().erase_expired(); n > 0) {
+				log_api::debug("Closed [{}] idle GenQuery2 cursor(s).", n);
 			}
 
+			if (_input->continuation_token) {
+				return read_next_page(_comm, _input, m, _output);
+			}
+
+			gq::options opts;
+
+			opts.database = gq2::get_plugin_configuration().database;
 			opts.username = _comm->clientUser.userName; // TODO Handle remote users?
 			opts.admin_mode = irods::is_privileged_client(*_comm);
+			opts.count_only = 0 != _input->count_only;
 			//opts.default_number_of_rows = 8; // TODO Can be pulled from the catalog on server startup.
 
-			irods::experimental::genquery2::driver driver;
+			// Cursors return every row matched by the query, one page at a time. The default limit
+			// would defeat that, so it is only applied to queries executed without a cursor.
+			const auto use_cursor = _input->page_size > 0;
 
-			if (const auto ec = driver.parse(_input->query_string); ec != 0) {
-				log_api::error("Failed to parse GenQuery2 string. [error code=[{}]]", ec);
-				return SYS_LIBRARY_ERROR;
+			if (use_cursor) {
+				opts.default_number_of_rows = 0;
 			}
 
-			const auto [sql, values] = gq::to_sql(driver.select, opts);
+			auto translation = gq2::translate(_input->query_string, opts, m);
+			const auto& sql = translation.sql;
+			const auto& values = translation.values;
+			const auto& columns = translation.columns;
 
 			log_api::trace("Returning to client: [{}]", sql);
 
@@ -139,31 +492,148 @@ namespace
 				return SYS_INVALID_INPUT_PARAM;
 			}
 
-			auto [db_inst, db_conn] = irods::experimental::catalog::new_database_connection();
+			if (GENQUERY2_EXPLAIN_NONE != _input->explain) {
+				return explain_query(_comm, _input, translation, _output);
+			}
 
-			nanodbc::statement stmt{db_conn};
-			nanodbc::prepare(stmt, sql);
+			// May replace the translation with one which produces fewer rows.
+			if (const auto ec = gq2::apply_admission_control(_comm, _input->query_string, opts, translation, m); ec < 0) {
+				return ec;
+			}
 
-			for (std::vector<std::string>::size_type i = 0; i < values.size(); ++i) {
-				stmt.bind(static_cast<short>(i), values.at(i).c_str());
+			if (use_cursor) {
+				return open_cursor(_comm, _input, translation, m, _output);
+			}
+
+			// Hot queries (e.g. resource and user lookups) are executed by many agents at once.
+			// Their results are shared via the result cache.
+			auto* result_cache = is_result_cacheable(_input) ? gq2::get_result_cache() : nullptr;
+			std::string result_cache_key;
+			std::optional<std::uint64_t> result_cache_generation;
+
+			if (result_cache) {
+				result_cache_key = make_result_cache_key(translation);
+				auto lookup = result_cache->find(result_cache_key, gq2::referenced_tables(translation.sql));
+
+				if (lookup.value) {
+					log_api::trace("Serving GenQuery2 result from the result cache.");
+					*_output = strdup(lookup.value->c_str());
+					return 0;
+				}
+
+				result_cache_generation = lookup.generation;
 			}
 
-			auto json_array = json::array();
-			auto json_row = json::array();
+			auto& pool = gq2::get_connection_pool();
+			auto db_conn = pool.acquire();
 
-			auto row = nanodbc::execute(stmt);
-			const auto n_cols = row.columns();
+			gq2::log_connection_pool_statistics();
 
-			while (row.next()) {
-				for (std::remove_cvref_t<decltype(n_cols)> i = 0; i < n_cols; ++i) {
-					json_row.push_back(row.get<std::string>(i, ""));
+			nanodbc::statement stmt{db_conn.get()};
+
+			{
+				const gq2::phase_timer timer{m, &gq2::request_metrics::prepare};
+
+				nanodbc::prepare(stmt, sql);
+
+				for (std::vector<std::string>::size_type i = 0; i < values.size(); ++i) {
+					stmt.bind(static_cast<short>(i), values.at(i).c_str());
 				}
+			}
 
-				json_array.push_back(json_row);
-				json_row.clear();
+			// Cancels the statement if it runs past its timeout or the client disconnects.
+			std::optional<gq2::statement_watchdog> watchdog;
+			watchdog.emplace(
+				stmt, gq2::watched_client_socket(*_comm), gq2::statement_timeout(_input->timeout_in_seconds));
+
+			std::optional<gq2::bulk_result> result;
+			watchdog->run([&] { gq2::execute(stmt, translation, result, m); });
+
+			constexpr auto all_rows = std::numeric_limits<std::size_t>::max();
+			const auto max_bytes = gq2::response_byte_budget(_input->max_response_bytes);
+			const auto report_truncation = _input->max_response_bytes > 0;
+			const auto include_metrics = _input->include_metrics != 0;
+			const auto wrap_in_object = include_metrics || report_truncation;
+
+			gq2::json_stream_writer writer;
+
+			// When metrics or a response size are requested, the response is {"rows": ...,
+			// "truncated": ..., "metrics": {...}}, or {"count": ..., "metrics": {...}} when counting.
+			if (wrap_in_object) {
+				writer.raw(opts.count_only ? R"({"count":)" : R"({"rows":)");
 			}
 
-			*_output = strdup(json_array.dump().c_str());
+			// True if the rows did not fit in max_bytes.
+			auto truncated = false;
+
+			if (opts.count_only) {
+				// The statement produces exactly one row holding one integer.
+				std::string count;
+
+				watchdog->run([&] {
+					const gq2::phase_timer timer{m, &gq2::request_metrics::fetch};
+
+					if (!result->next()) {
+						throw std::runtime_error{"Count query did not produce a row."};
+					}
+
+					result->get_ref(0, "0", count);
+				});
+
+				writer.raw(count);
+			}
+			else if (GENQUERY2_OUTPUT_FORMAT_ARROW == _input->output_format) {
+				gq2::arrow_stream_writer arrow_writer{columns};
+				truncated = watchdog->run(
+					[&] { return gq2::read_arrow_rows(*result, false, all_rows, max_bytes, arrow_writer, m); });
+
+				const gq2::phase_timer timer{m, &gq2::request_metrics::serialize};
+				const auto encoded = gq2::to_base64(arrow_writer.finish());
+
+				if (wrap_in_object) {
+					writer.string(encoded);
+				}
+				else {
+					writer.raw(encoded);
+				}
+			}
+			else {
+				truncated =
+					watchdog->run([&] { return gq2::read_json_rows(*result, false, all_rows, max_bytes, writer, m); });
+			}
+
+			// Clients which did not ask for a limit expect every row. Handing them part of the
+			// rows without saying so would be worse than failing.
+			if (truncated && !report_truncation) {
+				log_api::error("GenQuery2 response exceeds the maximum response size of [{}] bytes.", max_bytes);
+				return GENQUERY2_RESPONSE_TOO_LARGE;
+			}
+
+			if (report_truncation) {
+				writer.raw(truncated ? R"(,"truncated":true)" : R"(,"truncated":false)");
+			}
+
+			// Every row has been read. Obtaining the plan for the slow query log is not subject
+			// to the timeout.
+			watchdog.reset();
+
+			report_metrics(_input->query_string, &translation, m, include_metrics, writer);
+
+			if (wrap_in_object) {
+				writer.raw("}");
+			}
+
+			const auto output_size = writer.size();
+			*_output = writer.release();
+
+			if (result_cache_generation &&
+			    output_size <= gq2::get_plugin_configuration().result_cache_max_entry_bytes) {
+				result_cache->insert(result_cache_key, *result_cache_generation, {*_output, output_size});
+			}
+		}
+		catch (const gq2::statement_cancelled& e) {
+			log_api::error("GenQuery2 query was cancelled: {}", e.what());
+			return e.error_code();
 		}
 		catch (const nanodbc::database_error& e) {
 			log_api::error("Caught database exception while executing query: {}", e.what());
@@ -175,6 +645,316 @@ namespace
 		}
 
 		return 0;
+	} // execute_request
+
+	auto compress_output(const genquery2_input* _input, char** _output) -> int
+	{
+		if (GENQUERY2_COMPRESSION_NONE == _input->compression) {
+			return 0;
+		}
+
+		try {
+			const std::string_view uncompressed = *_output;
+			auto compressed = gq2::to_base64(gq2::compress(uncompressed));
+
+			log_api::trace("Compressed GenQuery2 response from [{}] to [{}] bytes.", uncompressed.size(), compressed.size());
+
+			std::free(*_output);
+			*_output = strdup(compressed.c_str());
+		}
+		catch (const std::exception& e) {
+			log_api::error("Caught exception while compressing response: {}", e.what());
+			std::free(*_output);
+			*_output = nullptr;
+			return SYS_LIBRARY_ERROR;
+		}
+
+		return 0;
+	} // compress_output
+
+	auto split_list(std::string_view _list) -> std::vector<std::string>
+	{
+		std::vector<std::string> elements;
+
+		for (std::string_view::size_type pos = 0; pos <= _list.size();) {
+			const auto end = std::min(_list.find(',', pos), _list.size());
+			auto element = _list.substr(pos, end - pos);
+			pos = end + 1;
+
+			while (!element.empty() && ' ' == element.front()) {
+				element.remove_prefix(1);
+			}
+
+			while (!element.empty() && ' ' == element.back()) {
+				element.remove_suffix(1);
+			}
+
+			if (!element.empty() && std::find(std::begin(elements), std::end(elements), element) == std::end(elements)) {
+				elements.emplace_back(element);
+			}
+		}
+
+		return elements;
+	} // split_list
+
+	auto list_zones(std::string_view _zones) -> std::vector<std::string>
+	{
+		if ("*" != _zones) {
+			return split_list(_zones);
+		}
+
+		std::vector<std::string> zones;
+
+		for (const auto* zi = ZoneInfoHead; zi; zi = zi->next) {
+			if (std::find(std::begin(zones), std::end(zones), zi->zoneName) == std::end(zones)) {
+				zones.emplace_back(zi->zoneName);
+			}
+		}
+
+		return zones;
+	} // list_zones
+
+	auto store_zone_output(gq2::zone_result& _result, int _ec, char* _output) -> void
+	{
+		irods::at_scope_exit free_output{[_output] { std::free(_output); }};
+
+		if (_ec < 0) {
+			log_api::error("GenQuery2 query failed in zone [{}]. [error code=[{}]]", _result.zone, _ec);
+			_result.error_code = _ec;
+			return;
+		}
+
+		try {
+			_result.rows = nlohmann::json::parse(_output ? _output : "[]");
+		}
+		catch (const std::exception& e) {
+			log_api::error("Could not parse GenQuery2 result of zone [{}]: {}", _result.zone, e.what());
+			_result.error_code = SYS_LIBRARY_ERROR;
+		}
+	} // store_zone_output
+
+	auto execute_across_zones(RsComm* _comm, const genquery2_input* _input, char** _output) -> int
+	{
+		if (!_input->query_string || _input->continuation_token || _input->page_size > 0 || 1 == _input->sql_only ||
+		    0 != _input->include_metrics || GENQUERY2_OUTPUT_FORMAT_JSON != _input->output_format ||
+		    _input->max_response_bytes > 0 || GENQUERY2_EXPLAIN_NONE != _input->explain)
+		{
+			log_api::error("Invalid input: querying multiple zones requires a query string and does not support "
+			               "cursors, sql_only, metrics, max_response_bytes, explain, or output formats other than "
+			               "JSON.");
+			return SYS_INVALID_INPUT_PARAM;
+		}
+
+		gq2::merge_spec spec;
+
+		try {
+			spec = gq2::make_merge_spec(_input->query_string,
+			                            gq::options{}.default_number_of_rows,
+			                            gq2::get_plugin_configuration().zones_use_byte_order_collation);
+		}
+		catch (const std::exception& e) {
+			log_api::error("Cannot query multiple zones: {}", e.what());
+			return SYS_INVALID_INPUT_PARAM;
+		}
+
+		const auto zones = list_zones(_input->zones);
+
+		if (zones.empty()) {
+			log_api::error("Invalid input: no zones listed.");
+			return SYS_INVALID_INPUT_PARAM;
+		}
+
+		std::vector<gq2::zone_result> results(zones.size());
+		std::vector<std::future<void>> remote_requests;
+		std::optional<std::size_t> local_zone_index;
+
+		// Each zone receives the original request minus the settings which only apply to the
+		// merged result.
+		const auto make_zone_input = [_input](const char* _zone) {
+			auto input = *_input;
+			input.zone = const_cast<char*>(_zone); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+			input.zones = nullptr;
+			input.compression = GENQUERY2_COMPRESSION_NONE;
+			return input;
+		};
+
+		for (std::size_t i = 0; i < zones.size(); ++i) {
+			auto& result = results[i];
+			result.zone = zones[i];
+
+			// Connecting to the remote zones is not thread-safe, so it is done one zone at a time.
+			// The queries themselves run concurrently, each on the connection of its zone.
+			rodsServerHost* host_info{};
+
+			if (const auto ec = gq2::resolve_catalog_provider(_comm, result.zone.c_str(), &host_info); ec < 0) {
+				result.error_code = ec;
+				continue;
+			}
+
+			if (LOCAL_HOST == host_info->localFlag) {
+				local_zone_index = i;
+				continue;
+			}
+
+			remote_requests.push_back(std::async(std::launch::async, [&result, host_info, &make_zone_input] {
+				auto input = make_zone_input(result.zone.c_str());
+				char* output{};
+
+				const auto ec = procApiRequest(
+					host_info->conn,
+					IRODS_APN_GENQUERY2,
+					&input,
+					nullptr,
+					reinterpret_cast<void**>(&output), // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+					nullptr);
+
+				store_zone_output(result, ec, output);
+			}));
+		}
+
+		// The local zone is queried while the remote zones work on the query.
+		if (local_zone_index) {
+			auto input = make_zone_input(nullptr);
+			char* output{};
+			const auto ec = execute_locally(_comm, &input, &output);
+			store_zone_output(results[*local_zone_index], ec, output);
+		}
+
+		for (auto&& f : remote_requests) {
+			f.get();
+		}
+
+		try {
+			gq2::json_stream_writer writer;
+			gq2::merge_zone_results(results, spec, writer);
+
+			*_output = writer.release();
+		}
+		catch (const std::exception& e) {
+			log_api::error("Caught exception while merging results of multiple zones: {}", e.what());
+			return SYS_LIBRARY_ERROR;
+		}
+
+		return 0;
+	} // execute_across_zones
+
+	auto call_genquery2(irods::api_entry* _api, RsComm* _comm, const genquery2_input* _input, char** _output) -> int
+	{
+		return _api->call_handler<const genquery2_input*, char**>(_comm, _input, _output);
+	} // call_genquery2
+
+	auto rs_genquery2(RsComm* _comm, const genquery2_input* _input, char** _output) -> int
+	{
+		if (!_input || !_output || (!_input->query_string && !_input->continuation_token && !_input->invalidate_tables)) {
+			log_api::error("Invalid input: received nullptr for message pointer and/or response pointer.");
+			return SYS_INVALID_INPUT_PARAM;
+		}
+
+		// Redirect to the catalog service provider based on the user-provided zone.
+		// This allows clients to query federated zones.
+		{
+			const auto to_sv = [](const char* _s) -> std::string_view { return _s ? _s : "nullptr"; };
+
+			log_api::trace("GenQuery2 API endpoint received: query_string=[{}], zone=[{}], page_size=[{}], "
+			               "continuation_token=[{}], output_format=[{}], include_metrics=[{}], timeout_in_seconds=[{}], "
+			               "compression=[{}], zones=[{}], count_only=[{}], max_response_bytes=[{}], "
+			               "explain=[{}], invalidate_tables=[{}]",
+			               to_sv(_input->query_string),
+			               to_sv(_input->zone),
+			               _input->page_size,
+			               to_sv(_input->continuation_token),
+			               _input->output_format,
+			               _input->include_metrics,
+			               _input->timeout_in_seconds,
+			               _input->compression,
+			               to_sv(_input->zones),
+			               _input->count_only,
+			               _input->max_response_bytes,
+			               _input->explain,
+			               to_sv(_input->invalidate_tables));
+		}
+
+		if (_input->output_format != GENQUERY2_OUTPUT_FORMAT_JSON &&
+		    _input->output_format != GENQUERY2_OUTPUT_FORMAT_ARROW) {
+			log_api::error("Invalid input: unknown output format [{}].", _input->output_format);
+			return SYS_INVALID_INPUT_PARAM;
+		}
+
+		if (_input->compression != GENQUERY2_COMPRESSION_NONE && _input->compression != GENQUERY2_COMPRESSION_ZLIB) {
+			log_api::error("Invalid input: unknown compression [{}].", _input->compression);
+			return SYS_INVALID_INPUT_PARAM;
+		}
+
+		if (0 != _input->count_only && (_input->page_size > 0 || _input->zones || _input->max_response_bytes > 0 ||
+		                                GENQUERY2_OUTPUT_FORMAT_JSON != _input->output_format)) {
+			log_api::error("Invalid input: count_only cannot be combined with cursors, zones, max_response_bytes, or "
+			               "output formats other than JSON.");
+			return SYS_INVALID_INPUT_PARAM;
+		}
+
+		if (_input->explain != GENQUERY2_EXPLAIN_NONE && _input->explain != GENQUERY2_EXPLAIN_PLAN &&
+		    _input->explain != GENQUERY2_EXPLAIN_ANALYZE) {
+			log_api::error("Invalid input: unknown explain mode [{}].", _input->explain);
+			return SYS_INVALID_INPUT_PARAM;
+		}
+
+		if (GENQUERY2_EXPLAIN_NONE != _input->explain &&
+		    (1 == _input->sql_only || _input->page_size > 0 || _input->continuation_token ||
+		     GENQUERY2_OUTPUT_FORMAT_JSON != _input->output_format)) {
+			log_api::error("Invalid input: explain cannot be combined with sql_only, cursors, or output formats other "
+			               "than JSON.");
+			return SYS_INVALID_INPUT_PARAM;
+		}
+
+		if (_input->max_response_bytes < 0) {
+			log_api::error("Invalid input: negative max_response_bytes [{}].", _input->max_response_bytes);
+			return SYS_INVALID_INPUT_PARAM;
+		}
+
+		if (_input->timeout_in_seconds < 0) {
+			log_api::error("Invalid input: negative timeout [{}].", _input->timeout_in_seconds);
+			return SYS_INVALID_INPUT_PARAM;
+		}
+
+		if (_input->zones) {
+			if (const auto ec = execute_across_zones(_comm, _input, _output); ec < 0) {
+				return ec;
+			}
+
+			return compress_output(_input, _output);
+		}
+
+		rodsServerHost* host_info{};
+
+		if (const auto ec = gq2::resolve_catalog_provider(_comm, _input->zone, &host_info); ec < 0) {
+			return ec;
+		}
+
+		if (host_info->localFlag != LOCAL_HOST) {
+			log_api::trace("Redirecting request to remote zone [{}].", _input->zone);
+
+			return procApiRequest(
+				host_info->conn,
+				IRODS_APN_GENQUERY2,
+				_input,
+				nullptr,
+				reinterpret_cast<void**>(_output), // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+				nullptr);
+		}
+
+		//
+		// At this point, we assume we're connected to the catalog service provider.
+		//
+
+		if (_input->invalidate_tables) {
+			return invalidate_result_cache(_comm, _input->invalidate_tables);
+		}
+
+		if (const auto ec = execute_locally(_comm, _input, _output); ec < 0) {
+			return ec;
+		}
+
+		return compress_output(_input, _output);
 	} // rs_genquery2
 } //namespace
 
@@ -0,0 +1,41 @@
+#include "allocation_counter.hpp"
+
+namespace
+{
+	std::size_t g_allocations = 0; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+} // anonymous namespace
+
+// Allocations are counted by wrapping the glibc allocator.
+extern "C" {
+auto __libc_malloc(std::size_t) -> void*;
+auto __libc_calloc(std::size_t, std::size_t) -> void*;
+auto __libc_realloc(void*, std::size_t) -> void*;
+
+// NOLINTBEGIN(cert-dcl58-cpp, bugprone-reserved-identifier)
+auto malloc(std::size_t _size) -> void*
+{
+	++g_allocations;
+	return __libc_malloc(_size);
+}
+
+auto calloc(std::size_t _n, std::size_t _size) -> void*
+{
+	++g_allocations;
+	return __libc_calloc(_n, _size);
+}
+
+auto realloc(void* _p, std::size_t _size) -> void*
+{
+	++g_allocations;
+	return __libc_realloc(_p, _size);
+}
+// NOLINTEND(cert-dcl58-cpp, bugprone-reserved-identifier)
+} // extern "C"
+
+namespace irods::experimental::genquery2::benchmark
+{
+	auto allocation_count() noexcept -> std::size_t
+	{
+		return g_allocations;
+	} // allocation_count
+} // namespace irods::experimental::genquery2::benchmark
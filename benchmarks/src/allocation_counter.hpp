@@ -0,0 +1,16 @@
+#ifndef IRODS_GENQUERY2_BENCHMARK_ALLOCATION_COUNTER_HPP
+#define IRODS_GENQUERY2_BENCHMARK_ALLOCATION_COUNTER_HPP
+
+#include <cstddef>
+
+namespace irods::experimental::genquery2::benchmark
+{
+	// Returns the number of heap allocations made by the process so far. Every allocation made
+	// through malloc, calloc, or realloc is counted, including those made by operator new.
+	//
+	// Benchmarks which use this must be built with allocation_counter.cpp. The count is not
+	// thread-safe, so it is only meaningful for single-threaded benchmarks.
+	auto allocation_count() noexcept -> std::size_t;
+} // namespace irods::experimental::genquery2::benchmark
+
+#endif // IRODS_GENQUERY2_BENCHMARK_ALLOCATION_COUNTER_HPP
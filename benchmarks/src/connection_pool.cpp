@@ -0,0 +1,111 @@
+// Measures the per-call latency of running a query on a fresh database connection versus
+// running it on a connection obtained from the GenQuery2 connection pool.
+//
+// Usage:
+//
+//     irods_genquery2_benchmark_connection_pool CONNECTION_STRING [ITERATIONS] [SQL]
+//
+// Example:
+//
+//     irods_genquery2_benchmark_connection_pool 'Driver=PostgreSQL;Server=localhost;Database=ICAT;Uid=irods' 1000
+
+#include "irods/plugins/api/private/genquery2_connection_pool.hpp"
+
+#include <fmt/format.h>
+#include <nanodbc/nanodbc.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+	namespace gq2 = irods::experimental::genquery2;
+
+	using clock_type = std::chrono::steady_clock;
+
+	auto run(const std::string& _conn_string, const std::string& _sql, int _iterations, std::size_t _pool_size)
+		-> std::vector<double>
+	{
+		gq2::connection_pool pool{[&_conn_string] { return nanodbc::connection{_conn_string}; },
+		                          gq2::connection_pool_options{.max_size = _pool_size}};
+
+		std::vector<double> latencies;
+		latencies.reserve(static_cast<std::size_t>(_iterations));
+
+		for (int i = 0; i < _iterations; ++i) {
+			const auto start = clock_type::now();
+
+			auto conn = pool.acquire();
+			nanodbc::statement stmt{conn.get()};
+			nanodbc::prepare(stmt, _sql);
+
+			auto row = nanodbc::execute(stmt);
+			while (row.next()) {
+			}
+
+			const auto elapsed = std::chrono::duration<double, std::micro>(clock_type::now() - start);
+			latencies.push_back(elapsed.count());
+		}
+
+		return latencies;
+	} // run
+
+	auto print_report(const std::string_view _label, std::vector<double> _latencies) -> void
+	{
+		std::sort(std::begin(_latencies), std::end(_latencies));
+
+		const auto percentile = [&_latencies](double _p) {
+			const auto idx = static_cast<std::size_t>(_p * static_cast<double>(_latencies.size() - 1));
+			return _latencies[idx];
+		};
+
+		const auto mean = std::accumulate(std::begin(_latencies), std::end(_latencies), 0.0) /
+		                  static_cast<double>(_latencies.size());
+
+		fmt::print("{:<12} calls={} mean={:.1f}us p50={:.1f}us p99={:.1f}us min={:.1f}us max={:.1f}us\n",
+		           _label,
+		           _latencies.size(),
+		           mean,
+		           percentile(0.50),
+		           percentile(0.99),
+		           _latencies.front(),
+		           _latencies.back());
+	} // print_report
+} // anonymous namespace
+
+int main(int _argc, char* _argv[]) // NOLINT(modernize-use-trailing-return-type)
+{
+	if (_argc < 2) {
+		fmt::print(stderr, "Usage: {} CONNECTION_STRING [ITERATIONS] [SQL]\n", _argv[0]);
+		return 1;
+	}
+
+	const std::string conn_string = _argv[1];
+	const int iterations = (_argc > 2) ? std::atoi(_argv[2]) : 1000;
+	const std::string sql = (_argc > 3) ? _argv[3] : "select zone_name from R_ZONE_MAIN";
+
+	if (iterations <= 0) {
+		fmt::print(stderr, "error: ITERATIONS must be greater than 0\n");
+		return 1;
+	}
+
+	try {
+		// A pool size of zero closes the connection after every call, which is equivalent
+		// to the behavior of the API plugin before pooling was introduced.
+		print_report("unpooled", run(conn_string, sql, iterations, 0));
+		print_report("pooled", run(conn_string, sql, iterations, 1));
+
+		return 0;
+	}
+	catch (const std::exception& e) {
+		fmt::print(stderr, "error: {}\n", e.what());
+	}
+
+	return 1;
+} // main
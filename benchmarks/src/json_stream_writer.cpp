@@ -0,0 +1,200 @@
+// Measures the time and number of heap allocations per row needed to serialize a result set
+// as JSON. The approach used by the API plugin before the streaming writer was introduced
+// (build an nlohmann::json DOM, dump it, and strdup the dump) is compared against the
+// streaming writer.
+//
+// The rows are synthetic, so no database is required. Each row resembles the result of
+// "select DATA_ID, COLL_NAME, DATA_NAME, DATA_SIZE".
+//
+// Usage:
+//
+//     irods_genquery2_benchmark_json_stream_writer [ROWS]
+
+#include "irods/plugins/api/private/genquery2_json_stream_writer.hpp"
+
+#include "allocation_counter.hpp"
+
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	namespace gq2 = irods::experimental::genquery2;
+
+	using gq2::benchmark::allocation_count;
+
+	using clock_type = std::chrono::steady_clock;
+
+	constexpr std::size_t columns_per_row = 4;
+
+	using row_type = std::array<std::string, columns_per_row>;
+
+	// Stands in for nanodbc::result. Each call to next() makes the next row current.
+	class fake_result
+	{
+	  public:
+		explicit fake_result(const std::vector<row_type>& _rows)
+			: rows_{&_rows}
+		{
+		}
+
+		auto next() -> bool
+		{
+			return ++index_ < rows_->size();
+		}
+
+		// Mirrors nanodbc::result::get<std::string>, which returns a new string.
+		auto get(std::size_t _column) const -> std::string
+		{
+			return (*rows_)[index_][_column];
+		}
+
+		// Mirrors nanodbc::result::get_ref, which copies into an existing string.
+		auto get_ref(std::size_t _column, std::string& _value) const -> void
+		{
+			_value.assign((*rows_)[index_][_column]);
+		}
+
+	  private:
+		const std::vector<row_type>* rows_;
+		std::size_t index_ = static_cast<std::size_t>(-1);
+	}; // class fake_result
+
+	struct measurement
+	{
+		double seconds;
+		std::size_t allocations;
+		std::string output;
+	}; // struct measurement
+
+	auto serialize_with_dom(const std::vector<row_type>& _rows) -> char*
+	{
+		fake_result result{_rows};
+
+		auto json_array = nlohmann::json::array();
+		auto json_row = nlohmann::json::array();
+
+		while (result.next()) {
+			for (std::size_t i = 0; i < columns_per_row; ++i) {
+				json_row.push_back(result.get(i));
+			}
+
+			json_array.push_back(json_row);
+			json_row.clear();
+		}
+
+		return strdup(json_array.dump().c_str());
+	} // serialize_with_dom
+
+	auto serialize_with_stream_writer(const std::vector<row_type>& _rows) -> char*
+	{
+		fake_result result{_rows};
+
+		gq2::json_stream_writer writer;
+		std::string value;
+		auto first_row = true;
+
+		writer.raw("[");
+
+		while (result.next()) {
+			writer.raw(first_row ? "[" : ",[");
+			first_row = false;
+
+			for (std::size_t i = 0; i < columns_per_row; ++i) {
+				if (i > 0) {
+					writer.raw(",");
+				}
+
+				result.get_ref(i, value);
+				writer.string(value);
+			}
+
+			writer.raw("]");
+		}
+
+		writer.raw("]");
+
+		return writer.release();
+	} // serialize_with_stream_writer
+
+	template <typename Function>
+	auto measure(Function _serialize, const std::vector<row_type>& _rows) -> measurement
+	{
+		const auto allocations_before = allocation_count();
+		const auto start = clock_type::now();
+
+		auto* output = _serialize(_rows);
+
+		const auto elapsed = std::chrono::duration<double>(clock_type::now() - start);
+		const auto allocations = allocation_count() - allocations_before;
+
+		std::string copy = output;
+		std::free(output); // NOLINT(cppcoreguidelines-owning-memory, cppcoreguidelines-no-malloc)
+
+		return {elapsed.count(), allocations, std::move(copy)};
+	} // measure
+
+	auto print_report(std::string_view _label, const measurement& _m, std::size_t _rows) -> void
+	{
+		const auto rows = static_cast<double>(_rows);
+
+		fmt::print("{:<14} rows={} time={:.3f}s ns/row={:.1f} allocations={} allocations/row={:.3f} bytes={}\n",
+		           _label,
+		           _rows,
+		           _m.seconds,
+		           _m.seconds * 1e9 / rows,
+		           _m.allocations,
+		           static_cast<double>(_m.allocations) / rows,
+		           _m.output.size());
+	} // print_report
+} // anonymous namespace
+
+int main(int _argc, char* _argv[]) // NOLINT(modernize-use-trailing-return-type)
+{
+	const auto n_rows = static_cast<std::size_t>((_argc > 1) ? std::atol(_argv[1]) : 1'000'000);
+
+	if (n_rows == 0) {
+		fmt::print(stderr, "error: ROWS must be greater than 0\n");
+		return 1;
+	}
+
+	try {
+		std::vector<row_type> rows;
+		rows.reserve(n_rows);
+
+		for (std::size_t i = 0; i < n_rows; ++i) {
+			rows.push_back({std::to_string(10'000 + i),
+			                fmt::format("/tempZone/home/rods/project_{}/data", i % 100),
+			                fmt::format("sample_{}.dat", i),
+			                std::to_string(i * 4096)});
+		}
+
+		const auto dom = measure(serialize_with_dom, rows);
+		const auto stream = measure(serialize_with_stream_writer, rows);
+
+		print_report("dom", dom, n_rows);
+		print_report("stream_writer", stream, n_rows);
+
+		if (dom.output != stream.output) {
+			fmt::print(stderr, "error: outputs differ\n");
+			return 1;
+		}
+
+		return 0;
+	}
+	catch (const std::exception& e) {
+		fmt::print(stderr, "error: {}\n", e.what());
+	}
+
+	return 1;
+} // main
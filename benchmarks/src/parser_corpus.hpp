@@ -0,0 +1,136 @@
+#ifndef IRODS_GENQUERY2_BENCHMARK_PARSER_CORPUS_HPP
+#define IRODS_GENQUERY2_BENCHMARK_PARSER_CORPUS_HPP
+
+#include "irods/genquery2_sql.hpp"
+
+#include <fmt/format.h>
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace irods::experimental::genquery2::benchmark
+{
+	// GenQuery2 strings resembling the queries issued by the iCommands and client libraries.
+	// clang-format off
+	inline constexpr auto parser_corpus = std::to_array<std::string_view>({
+		"select COLL_NAME, DATA_NAME where COLL_NAME = '/tempZone/home/rods'",
+		"select COLL_NAME, DATA_NAME, DATA_REPL_NUM, DATA_SIZE, DATA_CHECKSUM where COLL_NAME like '/tempZone/home/rods/%' order by DATA_NAME limit 1000",
+		"select DATA_ID where DATA_RESC_HIER in ('demoResc', 'pt;repl;ufs0', 'otherResc')",
+		"select COLL_NAME, DATA_NAME, RESC_NAME where META_DATA_ATTR_NAME = 'experiment' and META_DATA_ATTR_VALUE like 'run-%' and META_COLL_ATTR_NAME = 'project'",
+		"select USER_NAME, USER_ZONE where USER_TYPE = 'rodsuser' order by USER_NAME",
+		"select RESC_NAME, RESC_HOSTNAME, RESC_VAULT_PATH where RESC_TYPE_NAME = 'unixfilesystem'",
+		"select count(DATA_ID), sum(DATA_SIZE) where COLL_NAME like '/tempZone/home/%' and DATA_REPL_STATUS = '1' group by COLL_NAME",
+		"select DATA_ID, DATA_NAME where DATA_ID > '10042' order by DATA_ID fetch first 500 rows only",
+		"select COLL_NAME, DATA_NAME where (DATA_SIZE between '0' and '1024' or DATA_NAME like '%.txt') and not COLL_NAME like '/tempZone/trash/%'",
+		"select no distinct DATA_NAME, cast(DATA_SIZE as bigint) where DATA_CHECKSUM = 'sha2:47DEQpj8HBSa+/TImW+5JCeuQeRkm5NMpJWZG3hSuFU=' offset 10 limit 10",
+	});
+
+	inline constexpr auto simple_listing_queries = std::to_array<std::string_view>({
+		"select COLL_NAME, DATA_NAME where COLL_NAME = '/tempZone/home/rods'",
+		"select COLL_NAME where COLL_PARENT_NAME = '/tempZone/home/rods'",
+		"select COLL_NAME, DATA_NAME, DATA_REPL_NUM, DATA_SIZE, DATA_CHECKSUM where COLL_NAME like '/tempZone/home/rods/%' order by DATA_NAME limit 1000",
+		"select USER_NAME, USER_ZONE where USER_TYPE = 'rodsuser' order by USER_NAME",
+		"select RESC_NAME, RESC_HOSTNAME, RESC_VAULT_PATH where RESC_TYPE_NAME = 'unixfilesystem'",
+		"select ZONE_NAME, ZONE_TYPE, ZONE_CONNECTION where ZONE_TYPE = 'local'",
+	});
+
+	inline constexpr auto mixed_metadata_queries = std::to_array<std::string_view>({
+		"select COLL_NAME, DATA_NAME, RESC_NAME where META_DATA_ATTR_NAME = 'experiment' and META_DATA_ATTR_VALUE like 'run-%' and META_COLL_ATTR_NAME = 'project'",
+		"select COLL_NAME, META_COLL_ATTR_NAME, META_COLL_ATTR_VALUE, META_COLL_ATTR_UNITS where META_COLL_ATTR_NAME in ('project', 'owner') and COLL_NAME like '/tempZone/home/%'",
+		"select DATA_NAME, META_DATA_ATTR_VALUE where META_DATA_ATTR_NAME = 'temperature' and cast(META_DATA_ATTR_VALUE as integer) > '20' order by DATA_NAME",
+		"select RESC_NAME, META_RESC_ATTR_VALUE where META_RESC_ATTR_NAME = 'tier' and META_RESC_ATTR_VALUE != 'archive'",
+		"select USER_NAME, META_USER_ATTR_VALUE where META_USER_ATTR_NAME = 'department' and USER_TYPE = 'rodsuser'",
+		"select COLL_NAME, count(DATA_ID), sum(DATA_SIZE) where META_DATA_ATTR_NAME = 'instrument' and META_DATA_ATTR_VALUE = 'microscope' and DATA_REPL_STATUS = '1' group by COLL_NAME",
+	});
+
+	inline constexpr auto data_resc_hier_queries = std::to_array<std::string_view>({
+		"select DATA_ID where DATA_RESC_HIER in ('demoResc', 'pt;repl;ufs0', 'otherResc')",
+		"select COLL_NAME, DATA_NAME, DATA_RESC_HIER where DATA_RESC_HIER like 'pt;repl;%'",
+		"select DATA_NAME, DATA_RESC_HIER where DATA_RESC_HIER = 'demoResc' and COLL_NAME = '/tempZone/home/rods'",
+		"select DATA_NAME, DATA_REPL_NUM where COLL_NAME = '/tempZone/home/rods' and DATA_RESC_HIER not like 'pt;%'",
+	});
+	// clang-format on
+
+	// The resources referenced by data_resc_hier_queries, mapped by ID. Used when the
+	// hierarchies are resolved in memory. See gq::options.
+	inline auto make_resource_hierarchies() -> irods::experimental::api::genquery::resource_hierarchy_map
+	{
+		irods::experimental::api::genquery::resource_hierarchy_map hierarchies{
+			{"10014", "demoResc"}, {"10020", "otherResc"}, {"10030", "pt;repl;ufs0"}, {"10031", "pt;repl;ufs1"}};
+
+		// Zones usually have more resources than the queries refer to.
+		for (int i = 0; i < 32; ++i) {
+			hierarchies.emplace(fmt::format("{}", 10100 + i), fmt::format("compound{};cache{}", i, i));
+		}
+
+		return hierarchies;
+	} // make_resource_hierarchies
+
+	// Returns a query whose condition is an IN list of _size data object IDs.
+	inline auto make_in_list_query(std::size_t _size) -> std::string
+	{
+		std::string query = "select DATA_ID, DATA_NAME, DATA_SIZE where DATA_ID in (";
+
+		for (std::size_t i = 0; i < _size; ++i) {
+			if (i > 0) {
+				query += ", ";
+			}
+
+			query += fmt::format("'{}'", 10000 + i);
+		}
+
+		query += ')';
+
+		return query;
+	} // make_in_list_query
+
+	// Returns a query whose conditions are nested _depth levels deep. The levels alternate
+	// between "and" and "or", and every fourth level is negated.
+	inline auto make_nested_query(std::size_t _depth) -> std::string
+	{
+		std::string conditions = "DATA_NAME like '%.dat'";
+
+		for (std::size_t i = 0; i < _depth; ++i) {
+			conditions = fmt::format("{}DATA_SIZE > '{}' {} ({})",
+			                         (i % 4 == 3) ? "not " : "",
+			                         i * 1024,
+			                         (i % 2 == 0) ? "and" : "or",
+			                         conditions);
+		}
+
+		return fmt::format("select COLL_NAME, DATA_NAME where {}", conditions);
+	} // make_nested_query
+
+	// A set of GenQuery2 strings with a similar shape. The results of each category are
+	// reported separately.
+	struct corpus_category
+	{
+		std::string_view name;
+		std::vector<std::string> queries;
+
+		// Resolve DATA_RESC_HIER using make_resource_hierarchies() instead of a common table
+		// expression.
+		bool resolve_resource_hierarchies = false;
+	}; // struct corpus_category
+
+	inline auto make_categorized_corpus() -> std::vector<corpus_category>
+	{
+		const auto to_strings = [](auto&& _queries) {
+			return std::vector<std::string>(std::begin(_queries), std::end(_queries));
+		};
+
+		return {
+			{"simple_listing", to_strings(simple_listing_queries)},
+			{"mixed_metadata", to_strings(mixed_metadata_queries)},
+			{"data_resc_hier", to_strings(data_resc_hier_queries)},
+			{"data_resc_hier_resolved", to_strings(data_resc_hier_queries), true},
+			{"large_in_list", {make_in_list_query(100), make_in_list_query(1000)}},
+			{"deep_nesting", {make_nested_query(16), make_nested_query(64)}},
+		};
+	} // make_categorized_corpus
+} // namespace irods::experimental::genquery2::benchmark
+
+#endif // IRODS_GENQUERY2_BENCHMARK_PARSER_CORPUS_HPP
@@ -0,0 +1,246 @@
+// Measures how the throughput of the GenQuery2 parser scales with the number of threads. Each
+// thread parses the corpus repeatedly, either constructing a driver for every query or reusing
+// one driver for all of them.
+//
+// Every parse is checked against the result of parsing the same query on a single thread, so
+// drivers which share state across threads are detected. Building the benchmark with
+// -fsanitize=thread checks for data races as well.
+//
+// The corpus is defined in parser_corpus.hpp. No database is required.
+//
+// Usage:
+//
+//     irods_genquery2_benchmark_parser_threads [MAX_THREADS] [ITERATIONS]
+//
+// MAX_THREADS defaults to the number of hardware threads. ITERATIONS is the number of passes
+// over the corpus made by each thread (default: 10000).
+
+#include "irods/genquery2_driver.hpp"
+
+#include "parser_corpus.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	namespace gq = irods::experimental::api::genquery;
+	namespace gq2 = irods::experimental::genquery2;
+
+	using gq2::benchmark::parser_corpus;
+
+	using clock_type = std::chrono::steady_clock;
+
+	// The parts of a parse result compared across threads.
+	struct parse_result
+	{
+		int ec = 0;
+		std::size_t selections = 0;
+		std::size_t conditions = 0;
+		std::size_t group_by = 0;
+		std::size_t order_by = 0;
+		std::string offset;
+		std::string number_of_rows;
+		bool distinct = true;
+	}; // struct parse_result
+
+	auto matches(const parse_result& _expected, int _ec, const gq::select& _s) -> bool
+	{
+		return _expected.ec == _ec && _expected.selections == _s.selections.size() &&
+		       _expected.conditions == _s.conditions.size() && _expected.group_by == _s.group_by.columns.size() &&
+		       _expected.order_by == _s.order_by.sort_expressions.size() && _expected.offset == _s.range.offset &&
+		       _expected.number_of_rows == _s.range.number_of_rows && _expected.distinct == _s.distinct;
+	} // matches
+
+	auto parse_corpus_once() -> std::vector<parse_result>
+	{
+		std::vector<parse_result> results;
+		results.reserve(parser_corpus.size());
+
+		for (auto&& q : parser_corpus) {
+			gq2::driver d;
+			const auto ec = d.parse(q);
+			const auto& s = d.select;
+
+			results.push_back({ec,
+			                   s.selections.size(),
+			                   s.conditions.size(),
+			                   s.group_by.columns.size(),
+			                   s.order_by.sort_expressions.size(),
+			                   s.range.offset,
+			                   s.range.number_of_rows,
+			                   s.distinct});
+		}
+
+		return results;
+	} // parse_corpus_once
+
+	struct measurement
+	{
+		double seconds;
+		std::size_t mismatches;
+	}; // struct measurement
+
+	// Runs _parse on _threads threads. _parse receives the expected results and the number of
+	// iterations, and returns the number of mismatches it observed.
+	template <typename Function>
+	auto measure(Function _parse, int _threads, int _iterations, const std::vector<parse_result>& _expected)
+		-> measurement
+	{
+		std::atomic<int> ready{0};
+		std::atomic<bool> go{false};
+		std::atomic<std::size_t> mismatches{0};
+
+		std::vector<std::thread> threads;
+		threads.reserve(static_cast<std::size_t>(_threads));
+
+		for (int i = 0; i < _threads; ++i) {
+			threads.emplace_back([&] {
+				++ready;
+
+				while (!go.load(std::memory_order_acquire)) {
+					std::this_thread::yield();
+				}
+
+				mismatches += _parse(_expected, _iterations);
+			});
+		}
+
+		// The clock starts once every thread exists so that thread creation is not measured.
+		while (ready.load() != _threads) {
+			std::this_thread::yield();
+		}
+
+		const auto start = clock_type::now();
+		go.store(true, std::memory_order_release);
+
+		for (auto&& t : threads) {
+			t.join();
+		}
+
+		const auto elapsed = std::chrono::duration<double>(clock_type::now() - start);
+
+		return {elapsed.count(), mismatches.load()};
+	} // measure
+
+	// How a driver had to be used before it could be reused.
+	auto parse_with_fresh_drivers(const std::vector<parse_result>& _expected, int _iterations) -> std::size_t
+	{
+		std::size_t mismatches = 0;
+
+		for (int i = 0; i < _iterations; ++i) {
+			for (std::size_t q = 0; q < parser_corpus.size(); ++q) {
+				gq2::driver d;
+				const auto ec = d.parse(parser_corpus[q]);
+				mismatches += matches(_expected[q], ec, d.select) ? 0 : 1;
+			}
+		}
+
+		return mismatches;
+	} // parse_with_fresh_drivers
+
+	auto parse_with_reused_driver(const std::vector<parse_result>& _expected, int _iterations) -> std::size_t
+	{
+		std::size_t mismatches = 0;
+		gq2::driver d;
+
+		for (int i = 0; i < _iterations; ++i) {
+			for (std::size_t q = 0; q < parser_corpus.size(); ++q) {
+				const auto ec = d.parse(parser_corpus[q]);
+				mismatches += matches(_expected[q], ec, d.select) ? 0 : 1;
+			}
+		}
+
+		return mismatches;
+	} // parse_with_reused_driver
+
+	// Returns 1, 2, 4, ... up to and including _max_threads.
+	auto thread_counts(int _max_threads) -> std::vector<int>
+	{
+		std::vector<int> counts;
+
+		for (int n = 1; n < _max_threads; n *= 2) {
+			counts.push_back(n);
+		}
+
+		counts.push_back(_max_threads);
+
+		return counts;
+	} // thread_counts
+} // anonymous namespace
+
+int main(int _argc, char* _argv[]) // NOLINT(modernize-use-trailing-return-type)
+{
+	const auto hardware_threads = static_cast<int>(std::max(1U, std::thread::hardware_concurrency()));
+	const auto max_threads = (_argc > 1) ? std::atoi(_argv[1]) : hardware_threads;
+	const auto iterations = (_argc > 2) ? std::atoi(_argv[2]) : 10'000;
+
+	if (max_threads <= 0) {
+		fmt::print(stderr, "error: MAX_THREADS must be greater than 0\n");
+		return 1;
+	}
+
+	if (iterations <= 0) {
+		fmt::print(stderr, "error: ITERATIONS must be greater than 0\n");
+		return 1;
+	}
+
+	try {
+		const auto expected = parse_corpus_once();
+
+		if (std::any_of(std::begin(expected), std::end(expected), [](const parse_result& _r) { return _r.ec != 0; })) {
+			fmt::print(stderr, "error: the corpus contains queries which failed to parse\n");
+			return 1;
+		}
+
+		std::size_t total_mismatches = 0;
+		double fresh_baseline = 0;
+		double reused_baseline = 0;
+
+		for (auto n : thread_counts(max_threads)) {
+			const auto fresh = measure(parse_with_fresh_drivers, n, iterations, expected);
+			const auto reused = measure(parse_with_reused_driver, n, iterations, expected);
+
+			const auto queries = static_cast<double>(n) * iterations * static_cast<double>(parser_corpus.size());
+			const auto fresh_qps = queries / fresh.seconds;
+			const auto reused_qps = queries / reused.seconds;
+
+			if (n == 1) {
+				fresh_baseline = fresh_qps;
+				reused_baseline = reused_qps;
+			}
+
+			fmt::print("threads={:<3} fresh: queries/s={:.0f} speedup={:.2f}  reused: queries/s={:.0f} speedup={:.2f}  "
+			           "mismatches={}\n",
+			           n,
+			           fresh_qps,
+			           fresh_qps / fresh_baseline,
+			           reused_qps,
+			           reused_qps / reused_baseline,
+			           fresh.mismatches + reused.mismatches);
+
+			total_mismatches += fresh.mismatches + reused.mismatches;
+		}
+
+		if (total_mismatches != 0) {
+			fmt::print(stderr, "error: {} parses produced a different result than on a single thread\n", total_mismatches);
+			return 1;
+		}
+
+		return 0;
+	}
+	catch (const std::exception& e) {
+		fmt::print(stderr, "error: {}\n", e.what());
+	}
+
+	return 1;
+} // main
@@ -0,0 +1,248 @@
+// Measures the time and number of heap allocations needed to parse GenQuery2 strings and to
+// convert the resulting ASTs into SQL. The two phases are measured separately for each
+// category of the corpus (simple listings, mixed metadata, DATA_RESC_HIER, large IN lists, and
+// deep nesting) so that a regression can be attributed to the parser or to the SQL generator.
+//
+// Parsing reuses one driver, as the API plugin does. The strings are also parsed through a
+// std::istringstream, the only way to parse them before the driver accepted a std::string_view,
+// to show the cost of copying each string into a stream. The SQL generator is measured against
+// ASTs which were parsed beforehand. gq::to_sql reads the log level from the server
+// configuration on every call, so that cost is included.
+//
+// The corpus is defined in parser_corpus.hpp. No iRODS server or database is required.
+//
+// Passing --json writes the results as a JSON document, suitable for comparing runs.
+//
+// Usage:
+//
+//     irods_genquery2_benchmark_suite [--json] [ITERATIONS]
+
+#include "irods/genquery2_driver.hpp"
+#include "irods/genquery2_sql.hpp"
+
+#include "allocation_counter.hpp"
+#include "parser_corpus.hpp"
+
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+	namespace gq = irods::experimental::api::genquery;
+	namespace gq2 = irods::experimental::genquery2;
+
+	using gq2::benchmark::allocation_count;
+	using gq2::benchmark::corpus_category;
+
+	using clock_type = std::chrono::steady_clock;
+
+	struct measurement
+	{
+		std::string_view category;
+		std::string_view phase;
+		std::size_t queries;
+		double seconds;
+		std::size_t allocations;
+		std::size_t failures;
+	}; // struct measurement
+
+	// Runs _translate over every query of _category _iterations times. _translate returns false
+	// on failure.
+	template <typename Function>
+	auto measure(const corpus_category& _category, std::string_view _phase, int _iterations, Function _translate)
+		-> measurement
+	{
+		// Warms up the allocator and builds the state which is shared by all translations.
+		for (std::size_t q = 0; q < _category.queries.size(); ++q) {
+			_translate(q);
+		}
+
+		std::size_t failures = 0;
+
+		const auto allocations_before = allocation_count();
+		const auto start = clock_type::now();
+
+		for (int i = 0; i < _iterations; ++i) {
+			for (std::size_t q = 0; q < _category.queries.size(); ++q) {
+				if (!_translate(q)) {
+					++failures;
+				}
+			}
+		}
+
+		const auto elapsed = std::chrono::duration<double>(clock_type::now() - start);
+
+		return {_category.name,
+		        _phase,
+		        static_cast<std::size_t>(_iterations) * _category.queries.size(),
+		        elapsed.count(),
+		        allocation_count() - allocations_before,
+		        failures};
+	} // measure
+
+	auto measure_parse(const corpus_category& _category, int _iterations) -> measurement
+	{
+		gq2::driver d;
+
+		return measure(_category, "parse", _iterations, [&](std::size_t _q) {
+			return d.parse(_category.queries[_q]) == 0;
+		});
+	} // measure_parse
+
+	auto measure_parse_stream(const corpus_category& _category, int _iterations) -> measurement
+	{
+		gq2::driver d;
+
+		return measure(_category, "parse_stream", _iterations, [&](std::size_t _q) {
+			std::istringstream iss{std::string{_category.queries[_q]}};
+			return d.parse(iss) == 0;
+		});
+	} // measure_parse_stream
+
+	auto measure_to_sql(const corpus_category& _category,
+	                    const gq::resource_hierarchy_map& _hierarchies,
+	                    int _iterations) -> measurement
+	{
+		std::vector<std::unique_ptr<gq2::driver>> drivers;
+		drivers.reserve(_category.queries.size());
+
+		for (auto&& q : _category.queries) {
+			auto d = std::make_unique<gq2::driver>();
+
+			if (const auto ec = d->parse(q); ec != 0) {
+				throw std::invalid_argument{fmt::format("failed to parse [{}] [error code=[{}]]", q, ec)};
+			}
+
+			drivers.push_back(std::move(d));
+		}
+
+		gq::options opts;
+		opts.username = "rods";
+		opts.database = "postgres";
+		opts.max_number_of_rows = 256;
+
+		if (_category.resolve_resource_hierarchies) {
+			opts.resource_hierarchies = &_hierarchies;
+		}
+
+		return measure(_category, "to_sql", _iterations, [&](std::size_t _q) {
+			return !std::get<0>(gq::to_sql(drivers[_q]->select, opts)).empty();
+		});
+	} // measure_to_sql
+
+	auto ns_per_query(const measurement& _m) -> double
+	{
+		return _m.seconds * 1e9 / static_cast<double>(_m.queries);
+	} // ns_per_query
+
+	auto allocations_per_query(const measurement& _m) -> double
+	{
+		return static_cast<double>(_m.allocations) / static_cast<double>(_m.queries);
+	} // allocations_per_query
+
+	auto queries_per_second(const measurement& _m) -> double
+	{
+		return static_cast<double>(_m.queries) / _m.seconds;
+	} // queries_per_second
+
+	auto print_text_report(const std::vector<measurement>& _results) -> void
+	{
+		for (auto&& m : _results) {
+			fmt::print("{:<23} {:<12} queries={} ns/query={:.1f} allocations/query={:.1f} queries/s={:.0f} "
+			           "failures={}\n",
+			           m.category,
+			           m.phase,
+			           m.queries,
+			           ns_per_query(m),
+			           allocations_per_query(m),
+			           queries_per_second(m),
+			           m.failures);
+		}
+	} // print_text_report
+
+	auto print_json_report(const std::vector<measurement>& _results, int _iterations) -> void
+	{
+		auto results = nlohmann::json::array();
+
+		for (auto&& m : _results) {
+			results.push_back({
+				{"category", m.category},
+				{"phase", m.phase},
+				{"queries", m.queries},
+				{"ns_per_query", ns_per_query(m)},
+				{"allocations_per_query", allocations_per_query(m)},
+				{"queries_per_second", queries_per_second(m)},
+				{"failures", m.failures},
+			});
+		}
+
+		const nlohmann::json report{{"iterations", _iterations}, {"results", std::move(results)}};
+		fmt::print("{}\n", report.dump(4));
+	} // print_json_report
+} // anonymous namespace
+
+int main(int _argc, char* _argv[]) // NOLINT(modernize-use-trailing-return-type)
+{
+	bool json = false;
+	int iterations = 10'000;
+
+	for (int i = 1; i < _argc; ++i) {
+		if (std::string_view{_argv[i]} == "--json") {
+			json = true;
+		}
+		else {
+			iterations = std::atoi(_argv[i]);
+		}
+	}
+
+	if (iterations <= 0) {
+		fmt::print(stderr, "error: ITERATIONS must be greater than 0\n");
+		return 1;
+	}
+
+	try {
+		const auto corpus = gq2::benchmark::make_categorized_corpus();
+		const auto hierarchies = gq2::benchmark::make_resource_hierarchies();
+
+		std::vector<measurement> results;
+		results.reserve(corpus.size() * 3);
+
+		for (auto&& c : corpus) {
+			results.push_back(measure_parse(c, iterations));
+			results.push_back(measure_parse_stream(c, iterations));
+			results.push_back(measure_to_sql(c, hierarchies, iterations));
+		}
+
+		if (json) {
+			print_json_report(results, iterations);
+		}
+		else {
+			print_text_report(results);
+		}
+
+		for (auto&& m : results) {
+			if (m.failures != 0) {
+				fmt::print(stderr, "error: the corpus contains queries which could not be translated\n");
+				return 1;
+			}
+		}
+
+		return 0;
+	}
+	catch (const std::exception& e) {
+		fmt::print(stderr, "error: {}\n", e.what());
+	}
+
+	return 1;
+} // main
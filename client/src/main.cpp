@@ -2,6 +2,7 @@
 
 #include "irods/table_column_key_maps.hpp"
 
+#include <irods/base64.h>
 #include <irods/client_connection.hpp>
 #include <irods/irods_at_scope_exit.hpp>
 #include <irods/irods_exception.hpp>
@@ -11,13 +12,27 @@
 
 #include <boost/program_options.hpp>
 #include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include <zlib.h>
 
 #include <algorithm>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 
 auto print_usage_info() -> void;
 auto print_columns_info() -> void;
+auto decode_base64(const char* _encoded) -> std::string;
+auto decompress(const std::string& _compressed) -> std::string;
+auto write_base64_decoded(const char* _encoded) -> void;
+auto execute_batch(const std::string& _zone) -> int;
 
 int main(int _argc, char* _argv[]) // NOLINT(modernize-use-trailing-return-type)
 {
@@ -29,10 +44,21 @@ int main(int _argc, char* _argv[]) // NOLINT(modernize-use-trailing-return-type)
 
 	// clang-format off
 	desc.add_options()
+		("arrow", po::bool_switch(), "")
+		("batch", po::bool_switch(), "")
 		("columns,c", po::bool_switch(), "")
+		("compress", po::bool_switch(), "")
+		("count", po::bool_switch(), "")
+		("explain", po::bool_switch(), "")
+		("explain-analyze", po::bool_switch(), "")
+		("max-bytes", po::value<int>(), "")
+		("metrics", po::bool_switch(), "")
+		("page-size", po::value<int>(), "")
 		("query_string", po::value<std::string>()->default_value("-"), "")
 		("sql-only", po::bool_switch(), "")
+		("timeout", po::value<int>(), "")
 		("zone,z", po::value<std::string>(), "")
+		("zones", po::value<std::string>(), "")
 		("help,h", "");
 	// clang-format on
 
@@ -56,6 +82,21 @@ int main(int _argc, char* _argv[]) // NOLINT(modernize-use-trailing-return-type)
 			return 0;
 		}
 
+		if (vm["batch"].as<bool>()) {
+			if (vm["arrow"].as<bool>() || vm["compress"].as<bool>() || vm["count"].as<bool>() ||
+			    vm["explain"].as<bool>() || vm["explain-analyze"].as<bool>() || vm["metrics"].as<bool>() ||
+			    vm["sql-only"].as<bool>() || vm.count("max-bytes") || vm.count("page-size") || vm.count("timeout") ||
+			    vm.count("zones")) {
+				fmt::print(stderr,
+				           "error: --batch cannot be combined with --arrow, --compress, --count, --explain, "
+				           "--explain-analyze, --max-bytes, --metrics, --page-size, --sql-only, --timeout, or "
+				           "--zones\n");
+				return 1;
+			}
+
+			return execute_batch(vm.count("zone") ? vm["zone"].as<std::string>() : std::string{});
+		}
+
 		genquery2_input input{};
 
 		if (vm.count("query_string") == 0) {
@@ -84,32 +125,158 @@ int main(int _argc, char* _argv[]) // NOLINT(modernize-use-trailing-return-type)
 			input.zone = zone.data();
 		}
 
+		std::string zones;
+		if (vm.count("zones")) {
+			if (vm.count("zone") || vm["arrow"].as<bool>() || vm["metrics"].as<bool>() || vm["sql-only"].as<bool>() ||
+			    vm.count("max-bytes") || vm.count("page-size")) {
+				fmt::print(stderr,
+				           "error: --zones cannot be combined with --arrow, --max-bytes, --metrics, --page-size, "
+				           "--sql-only, or --zone\n");
+				return 1;
+			}
+
+			zones = vm["zones"].as<std::string>();
+			input.zones = zones.data();
+		}
+
 		if (vm["sql-only"].as<bool>()) {
 			input.sql_only = 1;
 		}
 
-		irods::experimental::client_connection conn;
-		char* sql{};
-		irods::at_scope_exit free_sql{[&sql] {
-			if (sql) {
-				std::free(sql);
+		if (vm.count("page-size")) {
+			input.page_size = vm["page-size"].as<int>();
+
+			if (input.page_size <= 0) {
+				fmt::print(stderr, "error: PAGE_SIZE must be greater than 0\n");
+				return 1;
+			}
+		}
+
+		if (vm["arrow"].as<bool>()) {
+			// Each page would be a separate stream, so the output would not be readable as one.
+			if (input.page_size > 0) {
+				fmt::print(stderr, "error: --arrow cannot be combined with --page-size\n");
+				return 1;
+			}
+
+			input.output_format = GENQUERY2_OUTPUT_FORMAT_ARROW;
+		}
+
+		if (vm["metrics"].as<bool>()) {
+			input.include_metrics = 1;
+		}
+
+		if (vm["count"].as<bool>()) {
+			if (vm["arrow"].as<bool>() || vm.count("max-bytes") || vm.count("page-size") || vm.count("zones")) {
+				fmt::print(stderr,
+				           "error: --count cannot be combined with --arrow, --max-bytes, --page-size, or --zones\n");
+				return 1;
+			}
+
+			input.count_only = 1;
+		}
+
+		if (vm["explain"].as<bool>() || vm["explain-analyze"].as<bool>()) {
+			if (vm["arrow"].as<bool>() || vm["sql-only"].as<bool>() || vm.count("page-size") || vm.count("zones")) {
+				fmt::print(stderr,
+				           "error: --explain and --explain-analyze cannot be combined with --arrow, --page-size, "
+				           "--sql-only, or --zones\n");
+				return 1;
+			}
+
+			input.explain = vm["explain-analyze"].as<bool>() ? GENQUERY2_EXPLAIN_ANALYZE : GENQUERY2_EXPLAIN_PLAN;
+		}
+
+		if (vm["compress"].as<bool>()) {
+			input.compression = GENQUERY2_COMPRESSION_ZLIB;
+		}
+
+		if (vm.count("timeout")) {
+			input.timeout_in_seconds = vm["timeout"].as<int>();
+
+			if (input.timeout_in_seconds <= 0) {
+				fmt::print(stderr, "error: SECONDS must be greater than 0\n");
+				return 1;
 			}
-		}};
-
-		const auto ec =
-			procApiRequest(static_cast<RcComm*>(conn),
-		                   IRODS_APN_GENQUERY2,
-		                   &input,
-		                   nullptr,
-		                   reinterpret_cast<void**>(&sql), // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-		                   nullptr);
-
-		if (ec != 0) {
-			fmt::print(stderr, "error: {}\n", ec);
-			return 1;
 		}
 
-		fmt::print("{}\n", sql);
+		if (vm.count("max-bytes")) {
+			input.max_response_bytes = vm["max-bytes"].as<int>();
+
+			if (input.max_response_bytes <= 0) {
+				fmt::print(stderr, "error: BYTES must be greater than 0\n");
+				return 1;
+			}
+		}
+
+		irods::experimental::client_connection conn;
+		std::string continuation_token;
+
+		// When a cursor is used, each page is printed on its own line as it arrives.
+		do {
+			char* sql{};
+			irods::at_scope_exit free_sql{[&sql] {
+				if (sql) {
+					std::free(sql);
+				}
+			}};
+
+			const auto ec =
+				procApiRequest(static_cast<RcComm*>(conn),
+			                   IRODS_APN_GENQUERY2,
+			                   &input,
+			                   nullptr,
+			                   reinterpret_cast<void**>(&sql), // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+			                   nullptr);
+
+			if (ec != 0) {
+				fmt::print(stderr, "error: {}\n", ec);
+				return 1;
+			}
+
+			// A compressed response is restored before it is interpreted.
+			const char* response = sql;
+			std::string decompressed;
+
+			if (GENQUERY2_COMPRESSION_ZLIB == input.compression) {
+				decompressed = decompress(decode_base64(sql));
+				response = decompressed.c_str();
+			}
+
+			if (GENQUERY2_OUTPUT_FORMAT_ARROW == input.output_format && 0 == input.sql_only) {
+				if (0 == input.include_metrics && 0 == input.max_response_bytes) {
+					write_base64_decoded(response);
+					return 0;
+				}
+
+				// The stream is written to stdout, so the metrics are printed to stderr.
+				const auto object = nlohmann::json::parse(response);
+				write_base64_decoded(object.at("rows").get_ref<const std::string&>().c_str());
+
+				if (object.contains("metrics")) {
+					fmt::print(stderr, "{}\n", object.at("metrics").dump());
+				}
+
+				if (object.value("truncated", false)) {
+					fmt::print(stderr, "warning: the result was truncated to fit --max-bytes\n");
+				}
+
+				return 0;
+			}
+
+			fmt::print("{}\n", response);
+
+			input.continuation_token = nullptr;
+
+			if (input.page_size > 0 && 0 == input.sql_only) {
+				const auto& token = nlohmann::json::parse(response).at("continuation_token");
+
+				if (!token.is_null()) {
+					continuation_token = token.get<std::string>();
+					input.continuation_token = continuation_token.data();
+				}
+			}
+		} while (input.continuation_token);
 
 		return 0;
 	}
@@ -142,11 +309,58 @@ taken via stdin will be viewed as the QUERY_STRING to execute. For example:
 Mandatory arguments to long options are mandatory for short options too.
 
 Options:
+      --arrow           Write the results to stdout as an Apache Arrow IPC
+                        stream instead of JSON. Integer and timestamp columns
+                        are sent as 64-bit integers. Cannot be combined with
+                        --page-size.
+      --batch           Read one QUERY_STRING per line from stdin and execute
+                        all of them in a single request. The results are
+                        printed as a JSON array containing an object per
+                        query. Each object holds the error code of the query
+                        and, on success, its rows.
   -c, --columns         List columns supported by GenQuery2.
+      --count           Print the number of rows the query would return instead
+                        of the rows. ORDER BY, LIMIT, and OFFSET are ignored.
+                        Cannot be combined with --arrow, --page-size, or
+                        --zones.
+      --compress        Ask the server to compress the response. This reduces
+                        the time needed to transfer large results over slow
+                        networks at the cost of CPU time on both ends.
+      --explain         Print the generated SQL and the plan the database would
+                        use to execute it instead of the rows. The plan is
+                        obtained with the actual bind values.
+      --explain-analyze Same as --explain, but the query is executed and the
+                        plan includes the actual row counts and timings.
+                        Requires administrator privileges.
+      --max-bytes=BYTES Limit the size of the rows in the response to roughly
+                        BYTES. The rows are moved into the "rows" property of a
+                        JSON object whose "truncated" property tells whether
+                        rows were left out. With --page-size, the limit applies
+                        to each page instead. The server may enforce a smaller
+                        limit.
+      --metrics         Include the time spent in each phase of the request,
+                        the number of rows, and the number of bytes produced
+                        in the output. The rows are moved into the "rows"
+                        property of a JSON object. With --arrow, the metrics
+                        are printed to stderr instead.
+      --page-size=N     Execute the query using a server-side cursor and
+                        retrieve the results N rows at a time. Each page is
+                        printed as a JSON object on its own line. Unless the
+                        query contains a LIMIT, all matching rows are returned.
       --sql-only        Print the SQL generated by the parser. The generated
                         SQL will not be executed.
+      --timeout=SECONDS Cancel the query if the database does not finish it
+                        within SECONDS. With --page-size, the timeout applies
+                        to each page. The server may enforce a smaller
+                        timeout.
   -z, --zone=ZONE_NAME  The name of the zone to run the query against. Defaults
                         to the local zone.
+      --zones=ZONES     Run the query against several zones at once. ZONES is
+                        a comma-separated list of zone names, or * for every
+                        zone known to the server. The first element of each
+                        row is the name of its zone. ORDER BY and LIMIT apply
+                        to the combined rows. Zones which could not execute
+                        the query are listed in the "errors" property.
   -h, --help            Display this help message and exit.
 )_");
 
@@ -172,3 +386,126 @@ auto print_columns_info() -> void
 		fmt::print("{:{}} ({}.{})\n", _v.first, w, _v.second.table, _v.second.name);
 	});
 } // print_columns_info
+
+auto decode_base64(const char* _encoded) -> std::string
+{
+	const auto encoded_size = std::strlen(_encoded);
+
+	// Base64 decoding produces three bytes for every four characters.
+	unsigned long size = encoded_size / 4 * 3 + 3;
+	std::string decoded(size, '\0');
+
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+	if (const auto ec = base64_decode(reinterpret_cast<const unsigned char*>(_encoded),
+	                                  encoded_size,
+	                                  reinterpret_cast<unsigned char*>(decoded.data()),
+	                                  &size);
+	    ec != 0)
+	{
+		throw std::runtime_error{fmt::format("could not decode response [error code={}]", ec)};
+	}
+
+	decoded.resize(size);
+
+	return decoded;
+} // decode_base64
+
+auto decompress(const std::string& _compressed) -> std::string
+{
+	z_stream stream{};
+
+	if (const auto ec = inflateInit(&stream); ec != Z_OK) {
+		throw std::runtime_error{fmt::format("could not decompress response [error code={}]", ec)};
+	}
+
+	irods::at_scope_exit end_stream{[&stream] { inflateEnd(&stream); }};
+
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast, cppcoreguidelines-pro-type-const-cast)
+	stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(_compressed.data()));
+	stream.avail_in = static_cast<uInt>(_compressed.size());
+
+	// The size of the original response is unknown, so the output grows as needed.
+	std::string decompressed;
+	auto ec = Z_OK;
+
+	while (Z_STREAM_END != ec) {
+		const auto offset = decompressed.size();
+		decompressed.resize(std::max<std::size_t>(4096, offset * 2));
+
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+		stream.next_out = reinterpret_cast<Bytef*>(decompressed.data() + offset);
+		stream.avail_out = static_cast<uInt>(decompressed.size() - offset);
+
+		ec = inflate(&stream, Z_NO_FLUSH);
+
+		if (Z_OK != ec && Z_STREAM_END != ec) {
+			throw std::runtime_error{fmt::format("could not decompress response [error code={}]", ec)};
+		}
+
+		decompressed.resize(decompressed.size() - stream.avail_out);
+	}
+
+	return decompressed;
+} // decompress
+
+auto write_base64_decoded(const char* _encoded) -> void
+{
+	const auto decoded = decode_base64(_encoded);
+	std::fwrite(decoded.data(), 1, decoded.size(), stdout);
+} // write_base64_decoded
+
+auto execute_batch(const std::string& _zone) -> int
+{
+	std::vector<std::string> query_strings;
+
+	for (std::string line; std::getline(std::cin, line);) {
+		if (!line.empty()) {
+			query_strings.push_back(std::move(line));
+		}
+	}
+
+	if (query_strings.empty()) {
+		fmt::print(stderr, "error: Missing QUERY_STRING\n");
+		return 1;
+	}
+
+	std::vector<char*> pointers;
+	pointers.reserve(query_strings.size());
+	std::transform(std::begin(query_strings), std::end(query_strings), std::back_inserter(pointers), [](auto& _s) {
+		return _s.data();
+	});
+
+	genquery2_batch_input input{};
+	input.number_of_queries = static_cast<int>(pointers.size());
+	input.query_strings = pointers.data();
+
+	std::string zone = _zone;
+	if (!zone.empty()) {
+		input.zone = zone.data();
+	}
+
+	irods::experimental::client_connection conn;
+
+	char* results{};
+	irods::at_scope_exit free_results{[&results] {
+		if (results) {
+			std::free(results);
+		}
+	}};
+
+	const auto ec = procApiRequest(static_cast<RcComm*>(conn),
+	                               IRODS_APN_GENQUERY2_BATCH,
+	                               &input,
+	                               nullptr,
+	                               reinterpret_cast<void**>(&results), // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+	                               nullptr);
+
+	if (ec != 0) {
+		fmt::print(stderr, "error: {}\n", ec);
+		return 1;
+	}
+
+	fmt::print("{}\n", results);
+
+	return 0;
+} // execute_batch
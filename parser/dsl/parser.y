@@ -64,6 +64,7 @@ This option causes make_* functions to be generated for each token kind.
 
 %define api.token.prefix {IRODS_GENQUERY2_TOKEN_}
 %token
+    AFTER
     AND
     AS
     ASC
@@ -130,9 +131,11 @@ rules only.
 %precedence NOT
 
 %type <gq::selections>                   selections;
-%type <gq::conditions>                   conditions;
+%type <gq::node_index>                   conditions;
 %type <gq::group_by>                     group_by;
 %type <gq::order_by>                     order_by;
+%type <gq::keyset>                       keyset;
+%type <std::vector<std::string>>         keyset_values;
 %type <std::vector<gq::sort_expression>> sort_expr;
 %type <gq::range>                        range;
 %type <gq::selection>                    selection;
@@ -140,6 +143,7 @@ rules only.
 %type <gq::select_function>              select_function;
 %type <gq::condition>                    condition;
 %type <gq::condition_expression>         condition_expression;
+%type <gq::condition_expression>         negatable_condition_expression;
 %type <std::vector<std::string>>         list_of_string_literals;
 %type <std::vector<std::string>>         list_of_identifiers;
 
@@ -156,9 +160,9 @@ genquery:
 
 select:
     SELECT selections  { std::swap(drv.select.selections, $2); }
-  | SELECT selections WHERE conditions  { std::swap(drv.select.selections, $2); std::swap(drv.select.conditions, $4); }
+  | SELECT selections WHERE conditions  { std::swap(drv.select.selections, $2); }
   | SELECT NO DISTINCT selections  { drv.select.distinct = false; std::swap(drv.select.selections, $4); }
-  | SELECT NO DISTINCT selections WHERE conditions  { drv.select.distinct = false; std::swap(drv.select.selections, $4); std::swap(drv.select.conditions, $6); }
+  | SELECT NO DISTINCT selections WHERE conditions  { drv.select.distinct = false; std::swap(drv.select.selections, $4); }
 
 group_by:
     %empty
@@ -166,6 +170,7 @@ group_by:
 
 order_by:
     ORDER BY sort_expr  { std::swap($$.sort_expressions, $3); }
+  | ORDER BY sort_expr keyset  { std::swap($$.sort_expressions, $3); std::swap(drv.select.keyset, $4); }
 
 sort_expr:
     IDENTIFIER  { $$.push_back(gq::sort_expression{$1, true}); }
@@ -175,6 +180,14 @@ sort_expr:
   | sort_expr COMMA IDENTIFIER ASC  { $1.push_back(gq::sort_expression{$3, true}); std::swap($$, $1); }
   | sort_expr COMMA IDENTIFIER DESC  { $1.push_back(gq::sort_expression{$3, false}); std::swap($$, $1); }
 
+keyset:
+    AFTER PAREN_OPEN list_of_identifiers PAREN_CLOSE GREATER_THAN keyset_values  { std::swap($$.columns, $3); std::swap($$.values, $6); }
+  | AFTER PAREN_OPEN list_of_identifiers PAREN_CLOSE LESS_THAN keyset_values  { std::swap($$.columns, $3); std::swap($$.values, $6); $$.descending = true; }
+
+keyset_values:
+    STRING_LITERAL  { $$ = std::vector<std::string>{std::move($1)}; }
+  | PAREN_OPEN list_of_string_literals PAREN_CLOSE  { std::swap($$, $2); }
+
 range:
     OFFSET POSITIVE_INTEGER  { std::swap($$.offset, $2); }
   | OFFSET POSITIVE_INTEGER FETCH FIRST POSITIVE_INTEGER ROWS ONLY  { std::swap($$.offset, $2); std::swap($$.number_of_rows, $5); }
@@ -201,23 +214,25 @@ select_function:
     IDENTIFIER PAREN_OPEN column PAREN_CLOSE  { $$ = gq::select_function{std::move($1), gq::column{std::move($3)}}; }
     /*IDENTIFIER PAREN_OPEN IDENTIFIER PAREN_CLOSE  { $$ = gq::select_function{std::move($1), gq::column{std::move($3)}}; }*/
 
+/* The nodes are appended to drv.select.conditions as they are reduced. See gq::conditions. */
 conditions:
-    condition  { $$ = gq::conditions{std::move($1)}; }
-  | conditions AND conditions  { $1.push_back(gq::logical_and{std::move($3)}); std::swap($$, $1); }
-  | conditions OR conditions  { $1.push_back(gq::logical_or{std::move($3)}); std::swap($$, $1); }
-  | PAREN_OPEN conditions PAREN_CLOSE  { $$ = gq::conditions{gq::logical_grouping{std::move($2)}}; }
-  | NOT conditions  { $$ = gq::conditions{gq::logical_not{std::move($2)}}; }
+    condition  { $$ = gq::add_condition(drv.select.conditions, std::move($1)); }
+  | conditions AND conditions  { $$ = gq::add_condition(drv.select.conditions, gq::logical_and{$1, $3}); }
+  | conditions OR conditions  { $$ = gq::add_condition(drv.select.conditions, gq::logical_or{$1, $3}); }
+  | PAREN_OPEN conditions PAREN_CLOSE  { $$ = gq::add_condition(drv.select.conditions, gq::logical_grouping{$2}); }
+  | NOT conditions  { $$ = gq::add_condition(drv.select.conditions, gq::logical_not{$2}); }
 
 condition:
     column condition_expression  { $$ = gq::condition(std::move($1), std::move($2)); }
+  | column NOT negatable_condition_expression  { $$ = gq::condition(std::move($1), std::move($3), true); }
 
-condition_expression:
+negatable_condition_expression:
     LIKE STRING_LITERAL  { $$ = gq::condition_like(std::move($2)); }
-  | NOT LIKE STRING_LITERAL  { $$ = gq::condition_operator_not{gq::condition_like(std::move($3))}; }
   | IN PAREN_OPEN list_of_string_literals PAREN_CLOSE  { $$ = gq::condition_in(std::move($3)); }
-  | NOT IN PAREN_OPEN list_of_string_literals PAREN_CLOSE  { $$ = gq::condition_operator_not{gq::condition_in(std::move($4))}; }
   | BETWEEN STRING_LITERAL AND STRING_LITERAL  { $$ = gq::condition_between(std::move($2), std::move($4)); }
-  | NOT BETWEEN STRING_LITERAL AND STRING_LITERAL  { $$ = gq::condition_operator_not{gq::condition_between(std::move($3), std::move($5))}; }
+
+condition_expression:
+    negatable_condition_expression  { std::swap($$, $1); }
   | EQUAL STRING_LITERAL  { $$ = gq::condition_equal(std::move($2)); }
   | NOT_EQUAL STRING_LITERAL  { $$ = gq::condition_not_equal(std::move($2)); }
   | LESS_THAN STRING_LITERAL  { $$ = gq::condition_less_than(std::move($2)); }
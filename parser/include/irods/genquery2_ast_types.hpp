@@ -1,10 +1,10 @@
 #ifndef IRODS_GENQUERY2_ABSTRACT_SYNTAX_TREE_DATA_TYPES_HPP
 #define IRODS_GENQUERY2_ABSTRACT_SYNTAX_TREE_DATA_TYPES_HPP
 
-#include <boost/variant.hpp>
-
+#include <cstdint>
 #include <string>
 #include <utility>
+#include <variant>
 #include <vector>
 
 namespace irods::experimental::api::genquery
@@ -160,80 +160,81 @@ namespace irods::experimental::api::genquery
 	{
 	}; // struct condition_is_not_null
 
-	struct condition_operator_not;
-
-	using condition_expression = boost::variant<condition_like,
-	                                            condition_in,
-	                                            condition_between,
-	                                            condition_equal,
-	                                            condition_not_equal,
-	                                            condition_less_than,
-	                                            condition_less_than_or_equal_to,
-	                                            condition_greater_than,
-	                                            condition_greater_than_or_equal_to,
-	                                            condition_is_null,
-	                                            condition_is_not_null,
-	                                            boost::recursive_wrapper<condition_operator_not>>;
-
-	struct condition_operator_not
-	{
-		condition_operator_not() = default;
-
-		condition_operator_not(condition_expression expression)
-			: expression{std::move(expression)}
-		{
-		}
-
-		condition_expression expression;
-	}; // struct condition_operator_not
+	using condition_expression = std::variant<condition_like,
+	                                          condition_in,
+	                                          condition_between,
+	                                          condition_equal,
+	                                          condition_not_equal,
+	                                          condition_less_than,
+	                                          condition_less_than_or_equal_to,
+	                                          condition_greater_than,
+	                                          condition_greater_than_or_equal_to,
+	                                          condition_is_null,
+	                                          condition_is_not_null>;
 
 	struct condition
 	{
 		condition() = default;
 
-		condition(column column, condition_expression expression)
+		condition(column column, condition_expression expression, bool negated = false)
 			: column{std::move(column)}
 			, expression{std::move(expression)}
+			, negated{negated}
 		{
 		}
 
 		column column;
 		condition_expression expression;
-	}; // struct condition
-
-	struct logical_and;
-	struct logical_or;
-	struct logical_not;
-	struct logical_grouping;
 
-	using condition_type = boost::variant<logical_and, logical_or, logical_not, logical_grouping, condition>;
+		// True if the expression is preceded by NOT (e.g. "not like").
+		bool negated = false;
+	}; // struct condition
 
-	// clang-format off
-    using selection  = boost::variant<select_function, column>;
-    using selections = std::vector<selection>;
-    using conditions = std::vector<condition_type>;
-	// clang-format on
+	// The position of a node within select::conditions.
+	using node_index = std::uint32_t;
 
+	// The operands of AND and OR appear in the order they were written.
 	struct logical_and
 	{
-		conditions condition;
+		node_index lhs;
+		node_index rhs;
 	}; // struct logical_and
 
 	struct logical_or
 	{
-		conditions condition;
+		node_index lhs;
+		node_index rhs;
 	}; // struct logical_or
 
 	struct logical_not
 	{
-		conditions condition;
+		node_index condition;
 	}; // struct logical_not
 
 	struct logical_grouping
 	{
-		conditions conditions;
+		node_index conditions;
 	}; // struct logical_grouping
 
+	using condition_type = std::variant<logical_and, logical_or, logical_not, logical_grouping, condition>;
+
+	// "conditions" holds the nodes of the tree formed by the conditions of the WHERE clause.
+	// Nodes refer to their children by index and always follow them, so the last node is the
+	// root of the tree. The leaves (i.e. objects of type condition) appear in the order they
+	// were written.
+	// clang-format off
+    using selection  = std::variant<select_function, column>;
+    using selections = std::vector<selection>;
+    using conditions = std::vector<condition_type>;
+	// clang-format on
+
+	// Appends _node to _conditions and returns its index.
+	inline auto add_condition(conditions& _conditions, condition_type _node) -> node_index
+	{
+		_conditions.push_back(std::move(_node));
+		return static_cast<node_index>(_conditions.size() - 1);
+	} // add_condition
+
 	struct sort_expression
 	{
 		std::string column;
@@ -250,6 +251,17 @@ namespace irods::experimental::api::genquery
 		std::vector<sort_expression> sort_expressions;
 	}; // struct order_by
 
+	// Identifies the last row of the previous page when paginating via the sort keys of
+	// the ORDER BY clause (e.g. "order by DATA_ID after (DATA_ID) > '12345'").
+	struct keyset
+	{
+		std::vector<std::string> columns;
+		std::vector<std::string> values;
+
+		// True if the rows were requested using "<" (i.e. in descending order).
+		bool descending = false;
+	}; // struct keyset
+
 	struct range
 	{
 		std::string offset;
@@ -270,6 +282,7 @@ namespace irods::experimental::api::genquery
 		conditions conditions;
 		group_by group_by;
 		order_by order_by;
+		keyset keyset;
 		range range;
 		bool distinct = true;
 	}; // struct select
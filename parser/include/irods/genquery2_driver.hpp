@@ -10,7 +10,9 @@
 #  include <FlexLexer.h>
 #endif // yyFlexLexerOnce
 
+#include <iosfwd>
 #include <string>
+#include <string_view>
 
 // Give the expected function signature of the yylex() function to flex.
 // The parameter, drv, is required. It is referenced by the flex script, lexer.l.
@@ -20,12 +22,33 @@
 
 namespace irods::experimental::genquery2
 {
+	// Parses GenQuery2 strings.
+	//
+	// A driver may be reused for any number of parses. Each parse discards the results of the
+	// previous one, but keeps the buffer of the scanner and the stack of the parser, so reusing
+	// a driver avoids allocating them again. Hosts which parse on many threads should keep one
+	// driver per thread (e.g. via thread_local).
+	//
+	// Thread-safety: A driver MUST NOT be used by more than one thread at a time. Distinct
+	// drivers share no mutable state and may be used concurrently.
 	class driver
 	{
 	  public:
-		driver() = default;
+		driver();
 
-		auto parse(const std::string& _s) -> int;
+		driver(const driver&) = delete;
+		auto operator=(const driver&) -> driver& = delete;
+
+		// Parses _s in place. No copy of _s is made beyond the scanner's own buffer.
+		auto parse(std::string_view _s) -> int;
+
+		// Parses the contents of _in.
+		auto parse(std::istream& _in) -> int;
+
+		// Returns the driver to the state it was in before its first parse, without releasing
+		// the memory held by it. Called by parse(), so callers only need this to drop the AST
+		// of the previous parse early.
+		auto reset() -> void;
 
 		// Holds an AST-like representation of a GenQuery2 string.
 		irods::experimental::api::genquery::select select;
@@ -39,6 +62,10 @@ namespace irods::experimental::genquery2
 		// Used by the lexer to capture string literals.
 		// This aids in handling escape sequences.
 		std::string string_literal;
+
+	  private:
+		// Must be declared last. It holds a reference to the driver.
+		yy::parser parser_;
 	}; // class driver
 } // namespace irods::experimental::genquery2
 
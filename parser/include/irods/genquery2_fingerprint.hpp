@@ -0,0 +1,27 @@
+#ifndef IRODS_GENQUERY2_FINGERPRINT_HPP
+#define IRODS_GENQUERY2_FINGERPRINT_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace irods::experimental::api::genquery
+{
+	struct select;
+
+	// Returns the GenQuery2 string described by _select with every string literal, the contents
+	// of every IN list, the keyset values, and the LIMIT and OFFSET values replaced with
+	// placeholders. Keywords are upper case, whitespace is reduced to single spaces, and
+	// optional clauses appear in a fixed order. Queries which differ only in those respects
+	// (e.g. the name of a collection) produce the same string.
+	//
+	// The result describes the shape of a query. It is not meant to be parsed.
+	auto normalize(const select& _select) -> std::string;
+
+	// Returns a 64-bit hash (FNV-1a) of a string produced by normalize(). Unlike std::hash, the
+	// hash is the same on every host and in every process, so it can be used to group queries
+	// across agents and log files.
+	auto fingerprint(std::string_view _normalized_query) noexcept -> std::uint64_t;
+} // namespace irods::experimental::api::genquery
+
+#endif // IRODS_GENQUERY2_FINGERPRINT_HPP
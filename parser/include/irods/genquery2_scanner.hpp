@@ -8,6 +8,8 @@
 #endif // yyFlexLexerOnce
 
 #include <iosfwd> // For std::istream and std::ostream.
+#include <optional>
+#include <string_view>
 
 namespace irods::experimental::genquery2
 {
@@ -17,6 +19,22 @@ namespace irods::experimental::genquery2
 	{
 	  public:
 		auto yylex(driver& _driver) -> yy::parser::symbol_type;
+
+		// Scans _input in place. The input is handed to the scanner's buffer directly rather
+		// than through a stream. _input must remain valid until the scan is complete.
+		auto switch_input(std::string_view _input) -> void;
+
+		// Scans the contents of _input.
+		auto switch_input(std::istream& _input) -> void;
+
+	  protected:
+		// Called by the scanner whenever its buffer needs to be refilled.
+		auto LexerInput(char* _buffer, int _max_size) -> int override;
+
+	  private:
+		// The part of the input which has not been handed to the scanner yet. Empty if the
+		// scanner reads from a stream.
+		std::optional<std::string_view> input_;
 	}; // class scanner
 } // namespace irods::experimental::genquery2
 
@@ -1,23 +1,51 @@
 #ifndef IRODS_GENQUERY2_SQL_HPP
 #define IRODS_GENQUERY2_SQL_HPP
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <string_view>
+#include <tuple>
+#include <unordered_map>
 #include <vector>
 
 namespace irods::experimental::api::genquery
 {
 	struct select;
 
+	// Maps the ID of a resource to its hierarchy (e.g. "root;pt;leaf").
+	using resource_hierarchy_map = std::unordered_map<std::string, std::string>;
+
 	struct options
 	{
 		std::string_view username;
 		std::string_view database;
+		// The number of rows returned when the query does not specify a limit.
+		// Zero means no limit is applied.
 		std::uint16_t default_number_of_rows = 16;
+		// If non-zero, the number of rows is capped at this value, even if the query
+		// specifies a larger limit.
+		std::uint64_t max_number_of_rows = 0;
 		bool admin_mode = false;
+		// If true, the SQL produces a single row holding the number of rows the query would
+		// return. ORDER BY, LIMIT, and OFFSET are ignored.
+		bool count_only = false;
+		// If set, DATA_RESC_HIER is resolved via this map instead of a recursive common table
+		// expression, whenever the query allows it. Conditions on the column are replaced with
+		// conditions on the resource ID, and the column is projected as the resource ID. The
+		// caller must replace those IDs with their hierarchy. See to_sql.
+		const resource_hierarchy_map* resource_hierarchies = nullptr;
 	}; // struct options
 
-	auto to_sql(const select& _select, const options& _opts) -> std::tuple<std::string, std::vector<std::string>>;
+	// Returns the SQL, the bindable values, the positions within the bindable values which
+	// hold the username found in the options object, and the positions of the projected
+	// columns which hold a resource ID in place of DATA_RESC_HIER.
+	auto to_sql(const select& _select, const options& _opts)
+		-> std::tuple<std::string, std::vector<std::string>, std::vector<std::size_t>, std::vector<std::size_t>>;
+
+	// Returns true if _table_name names a catalog table (e.g. R_DATA_MAIN) the SQL produced
+	// by to_sql can read.
+	auto is_catalog_table(std::string_view _table_name) noexcept -> bool;
 } // namespace irods::experimental::api::genquery
 
 #endif // IRODS_GENQUERY2_SQL_HPP
@@ -6,10 +6,20 @@
 
 namespace irods::experimental::api::genquery
 {
+	// The native type of a column's values. The catalog stores timestamps as strings holding
+	// seconds since the epoch, so they are only distinguishable from text by this annotation.
+	enum class column_type
+	{
+		string,
+		integer,
+		timestamp
+	}; // enum class column_type
+
 	struct column_info
 	{
 		std::string_view table;
 		std::string_view name;
+		column_type type = column_type::string;
 
 		auto operator==(const column_info& _rhs) const noexcept -> bool
 		{
@@ -19,27 +29,27 @@ namespace irods::experimental::api::genquery
 
 	// clang-format off
 	const std::map<std::string_view, column_info> column_name_mappings{
-		{"ZONE_ID", {"R_ZONE_MAIN", "zone_id"}},
+		{"ZONE_ID", {"R_ZONE_MAIN", "zone_id", column_type::integer}},
 		{"ZONE_NAME", {"R_ZONE_MAIN", "zone_name"}},
 		{"ZONE_TYPE", {"R_ZONE_MAIN", "zone_type_name"}},
 		{"ZONE_CONNECTION", {"R_ZONE_MAIN", "zone_conn_string"}},
 		{"ZONE_COMMENT", {"R_ZONE_MAIN", "r_comment"}},
-		{"ZONE_CREATE_TIME", {"R_ZONE_MAIN", "create_ts"}},
-		{"ZONE_MODIFY_TIME", {"R_ZONE_MAIN", "modify_ts"}},
+		{"ZONE_CREATE_TIME", {"R_ZONE_MAIN", "create_ts", column_type::timestamp}},
+		{"ZONE_MODIFY_TIME", {"R_ZONE_MAIN", "modify_ts", column_type::timestamp}},
 
-		{"USER_ID", {"R_USER_MAIN", "user_id"}},
+		{"USER_ID", {"R_USER_MAIN", "user_id", column_type::integer}},
 		{"USER_NAME", {"R_USER_MAIN", "user_name"}},
 		{"USER_TYPE", {"R_USER_MAIN", "user_type_name"}},
 		{"USER_ZONE", {"R_USER_MAIN", "zone_name"}},
 		{"USER_INFO", {"R_USER_MAIN", "user_info"}},
 		{"USER_COMMENT", {"R_USER_MAIN", "r_comment"}},
-		{"USER_CREATE_TIME", {"R_USER_MAIN", "create_ts"}},
-		{"USER_MODIFY_TIME", {"R_USER_MAIN", "modify_ts"}},
-		{"USER_AUTH_ID", {"R_USER_AUTH", "user_id"}},
+		{"USER_CREATE_TIME", {"R_USER_MAIN", "create_ts", column_type::timestamp}},
+		{"USER_MODIFY_TIME", {"R_USER_MAIN", "modify_ts", column_type::timestamp}},
+		{"USER_AUTH_ID", {"R_USER_AUTH", "user_id", column_type::integer}},
 		{"USER_DN", {"R_USER_AUTH", "user_auth_name"}},
 		{"USER_DN_INVALID", {"R_USER_MAIN", "r_comment"}}, // For compatibility.
 
-		{"RESC_ID", {"R_RESC_MAIN", "resc_id"}},
+		{"RESC_ID", {"R_RESC_MAIN", "resc_id", column_type::integer}},
 		{"RESC_NAME", {"R_RESC_MAIN", "resc_name"}},
 		{"RESC_ZONE_NAME", {"R_RESC_MAIN", "zone_name"}},
 		{"RESC_TYPE_NAME", {"R_RESC_MAIN", "resc_type_name"}},
@@ -47,37 +57,37 @@ namespace irods::experimental::api::genquery
 		{"RESC_HOSTNAME", {"R_RESC_MAIN", "resc_net"}}, // Known as LOC in legacy GenQuery.
 		{"RESC_VAULT_PATH", {"R_RESC_MAIN", "resc_def_path"}},
 		{"RESC_FREE_SPACE", {"R_RESC_MAIN", "free_space"}},
-		{"RESC_FREE_SPACE_TIME", {"R_RESC_MAIN", "free_space_ts"}},
+		{"RESC_FREE_SPACE_TIME", {"R_RESC_MAIN", "free_space_ts", column_type::timestamp}},
 		{"RESC_INFO", {"R_RESC_MAIN", "resc_info"}},
 		{"RESC_COMMENT", {"R_RESC_MAIN", "r_comment"}},
 		{"RESC_STATUS", {"R_RESC_MAIN", "resc_status"}},
-		{"RESC_CREATE_TIME", {"R_RESC_MAIN", "create_ts"}},
-		{"RESC_MODIFY_TIME", {"R_RESC_MAIN", "modify_ts"}},
+		{"RESC_CREATE_TIME", {"R_RESC_MAIN", "create_ts", column_type::timestamp}},
+		{"RESC_MODIFY_TIME", {"R_RESC_MAIN", "modify_ts", column_type::timestamp}},
 		{"RESC_CHILDREN", {"R_RESC_MAIN", "resc_children"}},
 		{"RESC_CONTEXT", {"R_RESC_MAIN", "resc_context"}},
 		{"RESC_PARENT_ID", {"R_RESC_MAIN", "resc_parent"}},
 		{"RESC_PARENT_CONTEXT", {"R_RESC_MAIN", "resc_parent_context"}},
 
-		{"DATA_ID", {"R_DATA_MAIN", "data_id"}},
-		{"DATA_COLL_ID", {"R_DATA_MAIN", "coll_id"}},
+		{"DATA_ID", {"R_DATA_MAIN", "data_id", column_type::integer}},
+		{"DATA_COLL_ID", {"R_DATA_MAIN", "coll_id", column_type::integer}},
 		{"DATA_NAME", {"R_DATA_MAIN", "data_name"}},
-		{"DATA_REPL_NUM", {"R_DATA_MAIN", "data_repl_num"}},
+		{"DATA_REPL_NUM", {"R_DATA_MAIN", "data_repl_num", column_type::integer}},
 		{"DATA_VERSION", {"R_DATA_MAIN", "data_version"}},
 		{"DATA_TYPE_NAME", {"R_DATA_MAIN", "data_type_name"}},
-		{"DATA_SIZE", {"R_DATA_MAIN", "data_size"}},
+		{"DATA_SIZE", {"R_DATA_MAIN", "data_size", column_type::integer}},
 		{"DATA_PATH", {"R_DATA_MAIN", "data_path"}},
 		//{"DATA_OWNER_NAME",     {"R_DATA_MAIN", "data_owner_name"}}, // Misleading. Prefer DATA_USER_NAME.
 		//{"DATA_OWNER_ZONE",     {"R_DATA_MAIN", "data_owner_zone"}}, // Misleading. Prefer DATA_USER_ZONE.
-		{"DATA_REPL_STATUS", {"R_DATA_MAIN", "data_is_dirty"}},
+		{"DATA_REPL_STATUS", {"R_DATA_MAIN", "data_is_dirty", column_type::integer}},
 		{"DATA_STATUS", {"R_DATA_MAIN", "data_status"}},
 		{"DATA_CHECKSUM", {"R_DATA_MAIN", "data_checksum"}},
-		{"DATA_EXPIRY", {"R_DATA_MAIN", "data_expiry_ts"}},
-		{"DATA_MAP_ID", {"R_DATA_MAIN", "data_map_id"}},
+		{"DATA_EXPIRY", {"R_DATA_MAIN", "data_expiry_ts", column_type::timestamp}},
+		{"DATA_MAP_ID", {"R_DATA_MAIN", "data_map_id", column_type::integer}},
 		{"DATA_COMMENTS", {"R_DATA_MAIN", "r_comment"}},
-		{"DATA_CREATE_TIME", {"R_DATA_MAIN", "create_ts"}},
-		{"DATA_MODIFY_TIME", {"R_DATA_MAIN", "modify_ts"}},
+		{"DATA_CREATE_TIME", {"R_DATA_MAIN", "create_ts", column_type::timestamp}},
+		{"DATA_MODIFY_TIME", {"R_DATA_MAIN", "modify_ts", column_type::timestamp}},
 		{"DATA_MODE", {"R_DATA_MAIN", "data_mode"}},
-		{"DATA_RESC_ID", {"R_DATA_MAIN", "resc_id"}},
+		{"DATA_RESC_ID", {"R_DATA_MAIN", "resc_id", column_type::integer}},
 
 		//{"DATA_USER_NAME",      {"R_USER_MAIN", "user_name"}}, // TODO Special? Derived from R_USER_MAIN and R_OBJT_ACCESS.
 		//{"DATA_USER_ZONE",      {"R_USER_MAIN", "zone_name"}}, // TODO Special? Derived from R_USER_MAIN and R_OBJT_ACCESS.
@@ -87,16 +97,16 @@ namespace irods::experimental::api::genquery
 		// If the column, "hier", is ever changed, the WITH statement in the parser must be updated too.
 		{"DATA_RESC_HIER", {"", "hier"}},
 
-		{"COLL_ID", {"R_COLL_MAIN", "coll_id"}},
+		{"COLL_ID", {"R_COLL_MAIN", "coll_id", column_type::integer}},
 		{"COLL_NAME", {"R_COLL_MAIN", "coll_name"}},
 		{"COLL_PARENT_NAME", {"R_COLL_MAIN", "parent_coll_name"}},
 		//{"COLL_OWNER_NAME",  {"R_COLL_MAIN", "coll_owner_name"}}, // Misleading. Prefer COLL_USER_NAME.
 		//{"COLL_OWNER_ZONE",  {"R_COLL_MAIN", "coll_owner_zone"}}, // Misleading. Prefer COLL_USER_ZONE.
-		{"COLL_MAP_ID", {"R_COLL_MAIN", "coll_map_id"}},
+		{"COLL_MAP_ID", {"R_COLL_MAIN", "coll_map_id", column_type::integer}},
 		{"COLL_INHERITANCE", {"R_COLL_MAIN", "coll_inheritance"}},
 		{"COLL_COMMENTS", {"R_COLL_MAIN", "r_comment"}},
-		{"COLL_CREATE_TIME", {"R_COLL_MAIN", "create_ts"}},
-		{"COLL_MODIFY_TIME", {"R_COLL_MAIN", "modify_ts"}},
+		{"COLL_CREATE_TIME", {"R_COLL_MAIN", "create_ts", column_type::timestamp}},
+		{"COLL_MODIFY_TIME", {"R_COLL_MAIN", "modify_ts", column_type::timestamp}},
 		{"COLL_TYPE", {"R_COLL_MAIN", "coll_type"}},
 		{"COLL_INFO1", {"R_COLL_MAIN", "coll_info1"}},
 		{"COLL_INFO2", {"R_COLL_MAIN", "coll_info2"}},
@@ -107,48 +117,48 @@ namespace irods::experimental::api::genquery
 		{"META_DATA_ATTR_NAME", {"R_META_MAIN", "meta_attr_name"}},
 		{"META_DATA_ATTR_VALUE", {"R_META_MAIN", "meta_attr_value"}},
 		{"META_DATA_ATTR_UNITS", {"R_META_MAIN", "meta_attr_unit"}},
-		{"META_DATA_ATTR_ID", {"R_META_MAIN", "meta_id"}},
-		{"META_DATA_CREATE_TIME", {"R_META_MAIN", "create_ts"}},
-		{"META_DATA_MODIFY_TIME", {"R_META_MAIN", "modify_ts"}},
+		{"META_DATA_ATTR_ID", {"R_META_MAIN", "meta_id", column_type::integer}},
+		{"META_DATA_CREATE_TIME", {"R_META_MAIN", "create_ts", column_type::timestamp}},
+		{"META_DATA_MODIFY_TIME", {"R_META_MAIN", "modify_ts", column_type::timestamp}},
 
 		{"META_COLL_ATTR_NAME", {"R_META_MAIN", "meta_attr_name"}},
 		{"META_COLL_ATTR_VALUE", {"R_META_MAIN", "meta_attr_value"}},
 		{"META_COLL_ATTR_UNITS", {"R_META_MAIN", "meta_attr_unit"}},
-		{"META_COLL_ATTR_ID", {"R_META_MAIN", "meta_id"}},
-		{"META_COLL_CREATE_TIME", {"R_META_MAIN", "create_ts"}},
-		{"META_COLL_MODIFY_TIME", {"R_META_MAIN", "modify_ts"}},
+		{"META_COLL_ATTR_ID", {"R_META_MAIN", "meta_id", column_type::integer}},
+		{"META_COLL_CREATE_TIME", {"R_META_MAIN", "create_ts", column_type::timestamp}},
+		{"META_COLL_MODIFY_TIME", {"R_META_MAIN", "modify_ts", column_type::timestamp}},
 
 		{"META_RESC_ATTR_NAME", {"R_META_MAIN", "meta_attr_name"}},
 		{"META_RESC_ATTR_VALUE", {"R_META_MAIN", "meta_attr_value"}},
 		{"META_RESC_ATTR_UNITS", {"R_META_MAIN", "meta_attr_unit"}},
-		{"META_RESC_ATTR_ID", {"R_META_MAIN", "meta_id"}},
-		{"META_RESC_CREATE_TIME", {"R_META_MAIN", "create_ts"}},
-		{"META_RESC_MODIFY_TIME", {"R_META_MAIN", "modify_ts"}},
+		{"META_RESC_ATTR_ID", {"R_META_MAIN", "meta_id", column_type::integer}},
+		{"META_RESC_CREATE_TIME", {"R_META_MAIN", "create_ts", column_type::timestamp}},
+		{"META_RESC_MODIFY_TIME", {"R_META_MAIN", "modify_ts", column_type::timestamp}},
 
 		{"META_USER_ATTR_NAME", {"R_META_MAIN", "meta_attr_name"}},
 		{"META_USER_ATTR_VALUE", {"R_META_MAIN", "meta_attr_value"}},
 		{"META_USER_ATTR_UNITS", {"R_META_MAIN", "meta_attr_unit"}},
-		{"META_USER_ATTR_ID", {"R_META_MAIN", "meta_id"}},
-		{"META_USER_CREATE_TIME", {"R_META_MAIN", "create_ts"}},
-		{"META_USER_MODIFY_TIME", {"R_META_MAIN", "modify_ts"}},
+		{"META_USER_ATTR_ID", {"R_META_MAIN", "meta_id", column_type::integer}},
+		{"META_USER_CREATE_TIME", {"R_META_MAIN", "create_ts", column_type::timestamp}},
+		{"META_USER_MODIFY_TIME", {"R_META_MAIN", "modify_ts", column_type::timestamp}},
 
 		// TODO These columns require a bit of work.
 		// How should we handle groups?
 		// Is it okay to require multiple calls to GenQuery to resolve IDs to names?
-		{"GROUP_ID", {"R_USER_GROUP", "group_user_id"}},
-		{"GROUP_MEMBER_ID", {"R_USER_GROUP", "user_id"}},
+		{"GROUP_ID", {"R_USER_GROUP", "group_user_id", column_type::integer}},
+		{"GROUP_MEMBER_ID", {"R_USER_GROUP", "user_id", column_type::integer}},
 
-		{"DELAY_RULE_ID", {"R_RULE_EXEC", "rule_exec_id"}},
+		{"DELAY_RULE_ID", {"R_RULE_EXEC", "rule_exec_id", column_type::integer}},
 		{"DELAY_RULE_NAME", {"R_RULE_EXEC", "rule_name"}},
 		{"DELAY_RULE_REI_FILE_PATH", {"R_RULE_EXEC", "rei_file_path"}},
 		{"DELAY_RULE_USER_NAME", {"R_RULE_EXEC", "user_name"}},
 		{"DELAY_RULE_EXE_ADDRESS", {"R_RULE_EXEC", "exe_address"}},
-		{"DELAY_RULE_EXE_TIME", {"R_RULE_EXEC", "exe_time"}},
+		{"DELAY_RULE_EXE_TIME", {"R_RULE_EXEC", "exe_time", column_type::timestamp}},
 		{"DELAY_RULE_EXE_FREQUENCY", {"R_RULE_EXEC", "exe_frequency"}},
 		{"DELAY_RULE_PRIORITY", {"R_RULE_EXEC", "priority"}},
 		{"DELAY_RULE_ESTIMATED_EXE_TIME", {"R_RULE_EXEC", "estimated_exe_time"}},
 		{"DELAY_RULE_NOTIFICATION_ADDR", {"R_RULE_EXEC", "notification_addr"}},
-		{"DELAY_RULE_LAST_EXE_TIME", {"R_RULE_EXEC", "last_exe_time"}},
+		{"DELAY_RULE_LAST_EXE_TIME", {"R_RULE_EXEC", "last_exe_time", column_type::timestamp}},
 		{"DELAY_RULE_STATUS", {"R_RULE_EXEC", "exe_status"}},
 
 		//{"TOKEN_NAMESPACE", {"R_TOKN_MAIN", "token_namespace"}},
@@ -177,47 +187,47 @@ namespace irods::experimental::api::genquery
 		//{"QUOTA_USER_ZONE",         {"R_USER_MAIN", "zone_name"}}, // TODO special?
 		//{"QUOTA_RESC_NAME",         {"R_RESC_MAIN", "resc_name"}}, // TODO special?
 
-		{"DATA_ACCESS_PERM_ID", {"R_OBJT_ACCESS", "access_type_id"}},
+		{"DATA_ACCESS_PERM_ID", {"R_OBJT_ACCESS", "access_type_id", column_type::integer}},
 		{"DATA_ACCESS_PERM_NAME", {"R_TOKN_MAIN", "token_name"}},
-		{"DATA_ACCESS_USER_ID", {"R_OBJT_ACCESS", "user_id"}},
+		{"DATA_ACCESS_USER_ID", {"R_OBJT_ACCESS", "user_id", column_type::integer}},
 		{"DATA_ACCESS_USER_NAME", {"R_USER_MAIN", "user_name"}},
 		//{"DATA_ACCESS_DATA_ID",  {"R_OBJT_ACCESS", "object_id"}},
 		//{"DATA_ACCESS_NAME",     {"R_TOKN_MAIN", "token_name"}}, // TODO special?
 		//{"DATA_TOKEN_NAMESPACE", {"R_TOKN_MAIN", "token_namespace"}}, // TODO special?
 
-		{"COLL_ACCESS_PERM_ID", {"R_OBJT_ACCESS", "access_type_id"}},
+		{"COLL_ACCESS_PERM_ID", {"R_OBJT_ACCESS", "access_type_id", column_type::integer}},
 		{"COLL_ACCESS_PERM_NAME", {"R_TOKN_MAIN", "token_name"}},
-		{"COLL_ACCESS_USER_ID", {"R_OBJT_ACCESS", "user_id"}},
+		{"COLL_ACCESS_USER_ID", {"R_OBJT_ACCESS", "user_id", column_type::integer}},
 		{"COLL_ACCESS_USER_NAME", {"R_USER_NAME", "user_name"}},
 		//{"COLL_ACCESS_COLL_ID",  {"R_OBJT_ACCESS", "object_id"}},
 		//{"COLL_ACCESS_NAME",     {"R_TOKN_MAIN", "token_name"}}, // TODO special?
 		//{"COLL_TOKEN_NAMESPACE", {"R_TOKN_MAIN", "token_namespace"}}, // TODO special?
 
-		{"TICKET_ID", {"R_TICKET_MAIN", "ticket_id"}},
+		{"TICKET_ID", {"R_TICKET_MAIN", "ticket_id", column_type::integer}},
 		{"TICKET_STRING", {"R_TICKET_MAIN", "ticket_string"}},
 		{"TICKET_TYPE", {"R_TICKET_MAIN", "ticket_type"}},
-		{"TICKET_USER_ID", {"R_TICKET_MAIN", "user_id"}},
-		{"TICKET_OBJECT_ID", {"R_TICKET_MAIN", "object_id"}},
+		{"TICKET_USER_ID", {"R_TICKET_MAIN", "user_id", column_type::integer}},
+		{"TICKET_OBJECT_ID", {"R_TICKET_MAIN", "object_id", column_type::integer}},
 		{"TICKET_OBJECT_TYPE", {"R_TICKET_MAIN", "object_type"}},
-		{"TICKET_USES_LIMIT", {"R_TICKET_MAIN", "uses_limit"}},
-		{"TICKET_USES_COUNT", {"R_TICKET_MAIN", "uses_count"}},
-		{"TICKET_WRITE_FILE_LIMIT", {"R_TICKET_MAIN", "write_file_limit"}},
-		{"TICKET_WRITE_FILE_COUNT", {"R_TICKET_MAIN", "write_file_count"}},
-		{"TICKET_WRITE_BYTE_LIMIT", {"R_TICKET_MAIN", "write_byte_limit"}},
-		{"TICKET_WRITE_BYTE_COUNT", {"R_TICKET_MAIN", "write_byte_count"}},
-		{"TICKET_EXPIRY_TIME", {"R_TICKET_MAIN", "ticket_expiry_ts"}},
-		{"TICKET_CREATE_TIME", {"R_TICKET_MAIN", "create_time"}},
-		{"TICKET_MODIFY_TIME", {"R_TICKET_MAIN", "modify_time"}},
+		{"TICKET_USES_LIMIT", {"R_TICKET_MAIN", "uses_limit", column_type::integer}},
+		{"TICKET_USES_COUNT", {"R_TICKET_MAIN", "uses_count", column_type::integer}},
+		{"TICKET_WRITE_FILE_LIMIT", {"R_TICKET_MAIN", "write_file_limit", column_type::integer}},
+		{"TICKET_WRITE_FILE_COUNT", {"R_TICKET_MAIN", "write_file_count", column_type::integer}},
+		{"TICKET_WRITE_BYTE_LIMIT", {"R_TICKET_MAIN", "write_byte_limit", column_type::integer}},
+		{"TICKET_WRITE_BYTE_COUNT", {"R_TICKET_MAIN", "write_byte_count", column_type::integer}},
+		{"TICKET_EXPIRY_TIME", {"R_TICKET_MAIN", "ticket_expiry_ts", column_type::timestamp}},
+		{"TICKET_CREATE_TIME", {"R_TICKET_MAIN", "create_time", column_type::timestamp}},
+		{"TICKET_MODIFY_TIME", {"R_TICKET_MAIN", "modify_time", column_type::timestamp}},
 		//{"TICKET_LOGICAL_PATH",             {"R_TICKET_MAIN", "modify_time"}},
 
 		{"TICKET_ALLOWED_HOST", {"R_TICKET_ALLOWED_HOSTS", "host"}},
-		{"TICKET_ALLOWED_HOST_TICKET_ID", {"R_TICKET_ALLOWED_HOSTS", "ticket_id"}},
+		{"TICKET_ALLOWED_HOST_TICKET_ID", {"R_TICKET_ALLOWED_HOSTS", "ticket_id", column_type::integer}},
 
 		{"TICKET_ALLOWED_USER_NAME", {"R_TICKET_ALLOWED_USERS", "user_name"}},
-		{"TICKET_ALLOWED_USER_TICKET_ID", {"R_TICKET_ALLOWED_USERS", "ticket_id"}},
+		{"TICKET_ALLOWED_USER_TICKET_ID", {"R_TICKET_ALLOWED_USERS", "ticket_id", column_type::integer}},
 
 		{"TICKET_ALLOWED_GROUP_NAME", {"R_TICKET_ALLOWED_GROUPS", "group_name"}},
-		{"TICKET_ALLOWED_GROUP_TICKET_ID", {"R_TICKET_ALLOWED_GROUPS", "ticket_id"}},
+		{"TICKET_ALLOWED_GROUP_TICKET_ID", {"R_TICKET_ALLOWED_GROUPS", "ticket_id", column_type::integer}},
 
 		//{"TICKET_DATA_NAME",               {"R_DATA_MAIN", "data_name"}}, // TODO special?
 		//{"TICKET_COLL_NAME",               {"R_COLL_MAIN", "coll_name"}}, // TODO special?
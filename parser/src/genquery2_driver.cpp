@@ -1,17 +1,44 @@
 #include "irods/genquery2_driver.hpp"
 
-#include <sstream>
+#include <istream>
 
 namespace irods::experimental::genquery2
 {
-	auto driver::parse(const std::string& _s) -> int
+	driver::driver()
+		: parser_{*this}
 	{
-		location.initialize();
+	} // driver::driver
 
-		std::istringstream iss{_s};
-		lexer.switch_streams(&iss);
+	auto driver::parse(std::string_view _s) -> int
+	{
+		reset();
+		lexer.switch_input(_s);
+		return parser_.parse();
+	} // driver::parse
 
-		yy::parser p{*this};
-		return p.parse();
+	auto driver::parse(std::istream& _in) -> int
+	{
+		reset();
+		lexer.switch_input(_in);
+		return parser_.parse();
 	} // driver::parse
+
+	auto driver::reset() -> void
+	{
+		// The members of the AST are cleared rather than replaced so that their capacity is
+		// kept.
+		select.selections.clear();
+		select.conditions.clear();
+		select.group_by.columns.clear();
+		select.order_by.sort_expressions.clear();
+		select.keyset.columns.clear();
+		select.keyset.values.clear();
+		select.keyset.descending = false;
+		select.range.offset.clear();
+		select.range.number_of_rows.clear();
+		select.distinct = true;
+
+		string_literal.clear();
+		location.initialize();
+	} // driver::reset
 } // namespace irods::experimental::genquery2
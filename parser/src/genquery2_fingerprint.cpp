@@ -0,0 +1,211 @@
+#include "irods/genquery2_fingerprint.hpp"
+
+#include "irods/genquery2_ast_types.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <variant>
+#include <vector>
+
+namespace
+{
+	namespace gq = irods::experimental::api::genquery;
+
+	auto append_upper(std::string& _out, std::string_view _s) -> void
+	{
+		std::transform(std::begin(_s), std::end(_s), std::back_inserter(_out), [](unsigned char _c) {
+			return static_cast<char>(std::toupper(_c));
+		});
+	} // append_upper
+
+	// Column names are case-sensitive. Type names are not.
+	auto append_column(std::string& _out, const gq::column& _column) -> void
+	{
+		if (_column.type_name.empty()) {
+			_out += _column.name;
+			return;
+		}
+
+		_out += "CAST(";
+		_out += _column.name;
+		_out += " AS ";
+		append_upper(_out, _column.type_name);
+		_out += ')';
+	} // append_column
+
+	struct selection_visitor
+	{
+		auto operator()(const gq::column& _column) const -> void
+		{
+			append_column(*out, _column);
+		}
+
+		auto operator()(const gq::select_function& _select_function) const -> void
+		{
+			append_upper(*out, _select_function.name);
+			*out += '(';
+			append_column(*out, _select_function.column);
+			*out += ')';
+		}
+
+		std::string* out;
+	}; // struct selection_visitor
+
+	// Lists of any length map to the same text so that they do not split a query shape.
+	struct expression_visitor
+	{
+		// clang-format off
+		auto operator()(const gq::condition_like&) const -> std::string_view { return "LIKE ?"; }
+		auto operator()(const gq::condition_in&) const -> std::string_view { return "IN (...)"; }
+		auto operator()(const gq::condition_between&) const -> std::string_view { return "BETWEEN ? AND ?"; }
+		auto operator()(const gq::condition_equal&) const -> std::string_view { return "= ?"; }
+		auto operator()(const gq::condition_not_equal&) const -> std::string_view { return "!= ?"; }
+		auto operator()(const gq::condition_less_than&) const -> std::string_view { return "< ?"; }
+		auto operator()(const gq::condition_less_than_or_equal_to&) const -> std::string_view { return "<= ?"; }
+		auto operator()(const gq::condition_greater_than&) const -> std::string_view { return "> ?"; }
+		auto operator()(const gq::condition_greater_than_or_equal_to&) const -> std::string_view { return ">= ?"; }
+		auto operator()(const gq::condition_is_null&) const -> std::string_view { return "IS NULL"; }
+		auto operator()(const gq::condition_is_not_null&) const -> std::string_view { return "IS NOT NULL"; }
+		// clang-format on
+	}; // struct expression_visitor
+
+	// Walks the tree the same way to_sql does. See genquery2_sql.cpp.
+	auto append_conditions(std::string& _out, const gq::conditions& _conditions) -> void
+	{
+		// Either a node to expand or, if "node" is empty, text to append.
+		struct work_item
+		{
+			std::optional<gq::node_index> node;
+			std::string_view text;
+		}; // struct work_item
+
+		std::vector<work_item> stack;
+		stack.push_back({static_cast<gq::node_index>(_conditions.size() - 1), {}});
+
+		while (!stack.empty()) {
+			const auto item = stack.back();
+			stack.pop_back();
+
+			if (!item.node) {
+				_out += item.text;
+				continue;
+			}
+
+			const auto& node = _conditions[*item.node];
+
+			if (const auto* op_and = std::get_if<gq::logical_and>(&node); op_and) {
+				stack.push_back({op_and->rhs, {}});
+				stack.push_back({std::nullopt, " AND "});
+				stack.push_back({op_and->lhs, {}});
+			}
+			else if (const auto* op_or = std::get_if<gq::logical_or>(&node); op_or) {
+				stack.push_back({op_or->rhs, {}});
+				stack.push_back({std::nullopt, " OR "});
+				stack.push_back({op_or->lhs, {}});
+			}
+			else if (const auto* op_not = std::get_if<gq::logical_not>(&node); op_not) {
+				_out += "NOT ";
+				stack.push_back({op_not->condition, {}});
+			}
+			else if (const auto* grouping = std::get_if<gq::logical_grouping>(&node); grouping) {
+				_out += '(';
+				stack.push_back({std::nullopt, ")"});
+				stack.push_back({grouping->conditions, {}});
+			}
+			else {
+				const auto& condition = std::get<gq::condition>(node);
+				append_column(_out, condition.column);
+				_out += condition.negated ? " NOT " : " ";
+				_out += std::visit(expression_visitor{}, condition.expression);
+			}
+		}
+	} // append_conditions
+
+	auto append_identifiers(std::string& _out, const std::vector<std::string>& _identifiers) -> void
+	{
+		for (std::size_t i = 0; i < _identifiers.size(); ++i) {
+			if (i > 0) {
+				_out += ", ";
+			}
+
+			_out += _identifiers[i];
+		}
+	} // append_identifiers
+} // anonymous namespace
+
+namespace irods::experimental::api::genquery
+{
+	auto normalize(const select& _select) -> std::string
+	{
+		std::string out;
+		out.reserve(256);
+
+		out += _select.distinct ? "SELECT " : "SELECT NO DISTINCT ";
+
+		for (std::size_t i = 0; i < _select.selections.size(); ++i) {
+			if (i > 0) {
+				out += ", ";
+			}
+
+			std::visit(selection_visitor{&out}, _select.selections[i]);
+		}
+
+		if (!_select.conditions.empty()) {
+			out += " WHERE ";
+			append_conditions(out, _select.conditions);
+		}
+
+		if (!_select.group_by.columns.empty()) {
+			out += " GROUP BY ";
+			append_identifiers(out, _select.group_by.columns);
+		}
+
+		if (const auto& sort_expressions = _select.order_by.sort_expressions; !sort_expressions.empty()) {
+			out += " ORDER BY ";
+
+			for (std::size_t i = 0; i < sort_expressions.size(); ++i) {
+				if (i > 0) {
+					out += ", ";
+				}
+
+				out += sort_expressions[i].column;
+				out += sort_expressions[i].ascending_order ? " ASC" : " DESC";
+			}
+
+			if (const auto& keyset = _select.keyset; !keyset.columns.empty()) {
+				out += " AFTER (";
+				append_identifiers(out, keyset.columns);
+				out += keyset.descending ? ") < " : ") > ";
+				out += (keyset.values.size() == 1) ? "?" : "(...)";
+			}
+		}
+
+		if (!_select.range.number_of_rows.empty()) {
+			out += " LIMIT ?";
+		}
+
+		if (!_select.range.offset.empty()) {
+			out += " OFFSET ?";
+		}
+
+		return out;
+	} // normalize
+
+	auto fingerprint(std::string_view _normalized_query) noexcept -> std::uint64_t
+	{
+		constexpr std::uint64_t offset_basis = 14695981039346656037ULL;
+		constexpr std::uint64_t prime = 1099511628211ULL;
+
+		auto hash = offset_basis;
+
+		for (const unsigned char c : _normalized_query) {
+			hash ^= c;
+			hash *= prime;
+		}
+
+		return hash;
+	} // fingerprint
+} // namespace irods::experimental::api::genquery
@@ -17,10 +17,16 @@
 
 #include <algorithm>
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <map>
+#include <memory_resource>
+#include <optional>
 #include <stdexcept>
+#include <string>
 #include <string_view>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #if IRODS_VERSION_INTEGER < 4003001
@@ -76,22 +82,45 @@ namespace
 #endif
 	// clang-format on
 
+	// The resources whose hierarchy satisfies a condition on DATA_RESC_HIER.
+	struct resolved_hierarchy_condition
+	{
+		std::vector<std::string> resc_ids;
+
+		// True if resc_ids holds the resources which do NOT satisfy the condition. Whichever
+		// list is shorter is used.
+		bool negated = false;
+	}; // struct resolved_hierarchy_condition
+
+	// Maps a table name to its alias. The keys refer to the table names of table_column_key_maps.hpp,
+	// which are never destroyed.
+	using table_alias_map = std::pmr::map<std::string_view, std::pmr::string>;
+
 	struct gq_state
 	{
+		// The containers which only live as long as the translation allocate from _arena.
+		explicit gq_state(std::pmr::memory_resource* _arena)
+			: arena{_arena}
+			, ast_column_ptrs{_arena}
+			, sql_tables{_arena}
+			, table_aliases{_arena}
+		{
+		}
+
+		std::pmr::memory_resource* arena;
+
 		// Holds pointers to column objects which contain SQL CAST syntax.
 		// These pointers allow the parser to forward the SQL CAST text to the final output.
-		std::vector<const gq::column*> ast_column_ptrs;
+		std::pmr::vector<const gq::column*> ast_column_ptrs;
 
-		// TODO The following two vectors don't offer any real use to the implementation.
-		// We fill them with information, but never really use them for anything anymore.
-		// They can probably be removed.
-		std::vector<std::string> columns_for_select_clause;
-		std::vector<std::string> columns_for_where_clause;
-
-		std::vector<std::string_view> sql_tables;
-		std::map<std::string, std::string> table_aliases;
+		std::pmr::vector<std::string_view> sql_tables;
+		table_alias_map table_aliases;
 		std::vector<std::string> values;
 
+		// Holds the positions within "values" which refer to the name of the user executing the query.
+		// This allows callers to reuse the generated SQL for a different user.
+		std::vector<std::size_t> username_value_positions;
+
 		int table_alias_id = 0;
 
 		bool in_select_clause = false;
@@ -102,6 +131,18 @@ namespace
 		bool add_joins_for_meta_user = false;
 
 		bool add_sql_for_data_resc_hier = false;
+
+		// Set if DATA_RESC_HIER is resolved via the resource hierarchies found in the options
+		// object rather than the recursive WITH clause.
+		const gq::resource_hierarchy_map* resource_hierarchies = nullptr;
+
+		// The resources matched by each condition on DATA_RESC_HIER, in the order the conditions
+		// appear in the query.
+		std::vector<resolved_hierarchy_condition> resolved_hierarchy_conditions;
+		std::size_t next_resolved_hierarchy_condition = 0;
+
+		// The positions of the projected columns which hold a resource ID in place of DATA_RESC_HIER.
+		std::vector<std::size_t> resource_hierarchy_positions;
 	}; // struct gq_state
 
 	// clang-format off
@@ -214,7 +255,7 @@ namespace
 		return fmt::format("t{}", _state.table_alias_id++);
 	} // generate_table_alias
 
-	struct sql_visitor : public boost::static_visitor<std::string>
+	struct sql_visitor
 	{
 		explicit sql_visitor(gq_state& _state)
 			: state{&_state}
@@ -254,8 +295,8 @@ namespace
 	} // init_graph
 
 	auto generate_inner_joins(const graph_type& _graph,
-	                          const std::vector<std::string_view>& _tables,
-	                          const std::map<std::string, std::string>& _table_aliases) -> std::vector<std::string>
+	                          const std::pmr::vector<std::string_view>& _tables,
+	                          const table_alias_map& _table_aliases) -> std::vector<std::string>
 	{
 		const auto get_table_join = [&_graph, &_table_aliases](const auto& _t1, const auto& _t2) -> std::string {
 			auto t1_idx = to_index(_t1);
@@ -266,7 +307,7 @@ namespace
 				return {};
 			}
 
-			std::string_view t2_alias = _table_aliases.at(std::string{_t2});
+			std::string_view t2_alias = _table_aliases.at(_t2);
 			const auto sql = fmt::format("inner join {} {} on {}", _t2, t2_alias, _graph[edge].join_condition);
 
 			// It is likely that the order of the tables passed do NOT match the order of the join expression.
@@ -290,12 +331,12 @@ namespace
 
 		// Copy all entries from "_tables" into the list except the very first one.
 		// The first element is the table we are trying to join to. So, we consider that one handled.
-		std::vector<std::string> remaining{std::begin(_tables) + 1, std::end(_tables)};
+		std::vector<std::string_view> remaining{std::begin(_tables) + 1, std::end(_tables)};
 		log_gq::debug(fmt::format("remaining = [{}]", fmt::join(remaining, ", ")));
 
-		std::vector<std::string> processed;
+		std::vector<std::string_view> processed;
 		processed.reserve(_tables.size());
-		processed.push_back(std::string{_tables.front()});
+		processed.push_back(_tables.front());
 		log_gq::debug(fmt::format("processed = [{}]", fmt::join(processed, ", ")));
 
 		for (decltype(_tables.size()) i = 0; i < _tables.size() - 1; ++i) {
@@ -360,7 +401,7 @@ namespace
 		return sql;
 	} // generate_joins_for_metadata_columns
 
-	auto generate_joins_for_permissions(const std::map<std::string, std::string>& _table_aliases) -> std::string
+	auto generate_joins_for_permissions(const table_alias_map& _table_aliases) -> std::string
 	{
 		// Always include the joins if the query involves columns related to data objects and/or collections.
 		// This is required due to how columns in R_OBJT_ACCESS and other tables are handled.
@@ -394,6 +435,12 @@ namespace
 		return sql;
 	} // generate_joins_for_permissions
 
+	auto add_username_value(gq_state& _state, const gq::options& _opts) -> void
+	{
+		_state.username_value_positions.push_back(_state.values.size());
+		_state.values.push_back(std::string{_opts.username});
+	} // add_username_value
+
 	auto generate_condition_clause(gq_state& _state, const gq::options& _opts, const std::string _conditions)
 		-> std::string
 	{
@@ -466,16 +513,16 @@ namespace
 					sql += fmt::format(" and pdu.user_name = ? and pcu.user_name = ? and"
 					                   " pdoa.access_type_id >= {perm} and pcoa.access_type_id >= {perm}",
 					                   fmt::arg("perm", min_perm_level));
-					_state.values.push_back(std::string{_opts.username});
-					_state.values.push_back(std::string{_opts.username});
+					add_username_value(_state, _opts);
+					add_username_value(_state, _opts);
 				}
 				else if (d_iter != end) {
 					sql += fmt::format(" and pdu.user_name = ? and pdoa.access_type_id >= {}", min_perm_level);
-					_state.values.push_back(std::string{_opts.username});
+					add_username_value(_state, _opts);
 				}
 				else if (c_iter != end) {
 					sql += fmt::format(" and pcu.user_name = ? and pcoa.access_type_id >= {}", min_perm_level);
-					_state.values.push_back(std::string{_opts.username});
+					add_username_value(_state, _opts);
 				}
 			}
 
@@ -503,16 +550,16 @@ namespace
 				sql += fmt::format(" where pdu.user_name = ? and pcu.user_name = ?"
 				                   " and pdoa.access_type_id >= {perm} and pcoa.access_type_id >= {perm}",
 				                   fmt::arg("perm", min_perm_level));
-				_state.values.push_back(std::string{_opts.username});
-				_state.values.push_back(std::string{_opts.username});
+				add_username_value(_state, _opts);
+				add_username_value(_state, _opts);
 			}
 			else if (d_iter != end) {
 				sql += fmt::format(" where pdu.user_name = ? and pdoa.access_type_id >= {}", min_perm_level);
-				_state.values.push_back(std::string{_opts.username});
+				add_username_value(_state, _opts);
 			}
 			else if (c_iter != end) {
 				sql += fmt::format(" where pcu.user_name = ? and pcoa.access_type_id >= {}", min_perm_level);
-				_state.values.push_back(std::string{_opts.username});
+				add_username_value(_state, _opts);
 			}
 		}
 
@@ -551,7 +598,7 @@ namespace
 			// clang-format on
 
 			if (!is_special_column) {
-				alias = _state.table_aliases.at(std::string{iter->second.table});
+				alias = _state.table_aliases.at(iter->second.table);
 			}
 
 			const auto ast_iter =
@@ -576,6 +623,51 @@ namespace
 		return fmt::format(" group by {}", fmt::join(resolved_columns, ", "));
 	} // generate_group_by_clause
 
+	// Returns the SQL expression of a column named in the order-by clause (or the keyset) as
+	// it appears in the list of columns to project.
+	auto resolve_sort_column(const gq_state& _state,
+	                         const std::string& _column,
+	                         const std::map<std::string_view, gq::column_info>& _column_name_mappings)
+		-> std::string
+	{
+		const auto iter = _column_name_mappings.find(_column);
+
+		if (iter == std::end(_column_name_mappings)) {
+			throw std::invalid_argument{fmt::format("unknown column in order-by clause: {}", _column)};
+		}
+
+		auto is_special_column = true;
+		std::string_view alias;
+
+		// clang-format off
+		if      (_column.starts_with("META_D")) { alias = "mmd"; }
+		else if (_column.starts_with("META_C")) { alias = "mmc"; }
+		else if (_column.starts_with("META_R")) { alias = "mmr"; }
+		else if (_column.starts_with("META_U")) { alias = "mmu"; }
+		else if (_column == "DATA_RESC_HIER")   { alias = "cte_drh"; }
+		else                                    { is_special_column = false; }
+		// clang-format on
+
+		if (!is_special_column) {
+			alias = _state.table_aliases.at(iter->second.table);
+		}
+
+		const auto ast_iter = std::find_if(
+			std::begin(_state.ast_column_ptrs),
+			std::end(_state.ast_column_ptrs),
+			[&_column](const irods::experimental::api::genquery::column* _p) { return _p->name == _column; });
+
+		if (std::end(_state.ast_column_ptrs) == ast_iter) {
+			throw std::invalid_argument{"cannot generate SQL from General Query."};
+		}
+
+		if ((*ast_iter)->type_name.empty()) {
+			return fmt::format("{}.{}", alias, iter->second.name);
+		}
+
+		return fmt::format("cast({}.{} as {})", alias, iter->second.name, (*ast_iter)->type_name);
+	} // resolve_sort_column
+
 	auto generate_order_by_clause(const gq_state& _state,
 	                              const gq::order_by& _order_by,
 	                              const std::map<std::string_view, gq::column_info>& _column_name_mappings)
@@ -591,53 +683,102 @@ namespace
 		sort_expr.reserve(sort_expressions.size());
 
 		for (const auto& se : sort_expressions) {
-			const auto iter = _column_name_mappings.find(se.column);
+			sort_expr.push_back(fmt::format("{} {}",
+			                                resolve_sort_column(_state, se.column, _column_name_mappings),
+			                                se.ascending_order ? "asc" : "desc"));
+		}
 
-			if (iter == std::end(_column_name_mappings)) {
-				throw std::invalid_argument{fmt::format("unknown column in order-by clause: {}", se.column)};
-			}
+		// All columns in the order by clause must exist in the list of columns to project.
+		return fmt::format(" order by {}", fmt::join(sort_expr, ", "));
+	} // generate_order_by_clause
 
-			auto is_special_column = true;
-			std::string_view alias;
+	// Returns a predicate which matches the rows following the row identified by the keyset,
+	// in the order defined by the order-by clause. Unlike OFFSET, this allows the database
+	// to start reading from the position of the keyset in an index.
+	auto generate_keyset_predicate(gq_state& _state,
+	                               const gq::options& _opts,
+	                               const gq::select& _select,
+	                               const std::map<std::string_view, gq::column_info>& _column_name_mappings)
+		-> std::string
+	{
+		const auto& keyset = _select.keyset;
 
-			// clang-format off
-			if      (se.column.starts_with("META_D")) { alias = "mmd"; }
-			else if (se.column.starts_with("META_C")) { alias = "mmc"; }
-			else if (se.column.starts_with("META_R")) { alias = "mmr"; }
-			else if (se.column.starts_with("META_U")) { alias = "mmu"; }
-			else if (se.column == "DATA_RESC_HIER")   { alias = "cte_drh"; }
-			else                                      { is_special_column = false; }
-			// clang-format on
+		if (keyset.columns.empty()) {
+			return {};
+		}
 
-			if (!is_special_column) {
-				alias = _state.table_aliases.at(std::string{iter->second.table});
-			}
+		const auto& sort_expressions = _select.order_by.sort_expressions;
 
-			const auto ast_iter = std::find_if(
-				std::begin(_state.ast_column_ptrs),
-				std::end(_state.ast_column_ptrs),
-				[&se](const irods::experimental::api::genquery::column* _p) { return _p->name == se.column; });
+		// The keyset identifies a row by all of its sort keys. Anything less would skip or
+		// repeat the rows which share a prefix of the sort keys.
+		if (!std::equal(std::begin(keyset.columns),
+		                std::end(keyset.columns),
+		                std::begin(sort_expressions),
+		                std::end(sort_expressions),
+		                [](const std::string& _c, const gq::sort_expression& _se) { return _c == _se.column; }))
+		{
+			throw std::invalid_argument{"keyset columns must match the columns of the order-by clause"};
+		}
 
-			if (std::end(_state.ast_column_ptrs) == ast_iter) {
-				throw std::invalid_argument{"cannot generate SQL from General Query."};
-			}
+		if (keyset.values.size() != keyset.columns.size()) {
+			throw std::invalid_argument{"keyset must contain one value per column"};
+		}
 
-			if ((*ast_iter)->type_name.empty()) {
-				sort_expr.push_back(
-					fmt::format("{}.{} {}", alias, iter->second.name, se.ascending_order ? "asc" : "desc"));
-			}
-			else {
-				sort_expr.push_back(fmt::format("cast({}.{} as {}) {}",
-				                                alias,
-				                                iter->second.name,
-				                                (*ast_iter)->type_name,
-				                                se.ascending_order ? "asc" : "desc"));
+		if (keyset.descending == sort_expressions.front().ascending_order) {
+			throw std::invalid_argument{
+				"keyset operator must be > for ascending order and < for descending order of the first column"};
+		}
+
+		std::vector<std::string> columns;
+		columns.reserve(keyset.columns.size());
+
+		for (auto&& c : keyset.columns) {
+			columns.push_back(resolve_sort_column(_state, c, _column_name_mappings));
+		}
+
+		const auto op = [](const gq::sort_expression& _se) { return _se.ascending_order ? ">" : "<"; };
+
+		if (1 == columns.size()) {
+			_state.values.push_back(keyset.values.front());
+			return fmt::format("{} {} ?", columns.front(), op(sort_expressions.front()));
+		}
+
+		const auto same_direction =
+			std::all_of(std::begin(sort_expressions), std::end(sort_expressions), [&sort_expressions](auto&& _se) {
+				return _se.ascending_order == sort_expressions.front().ascending_order;
+			});
+
+		// Databases can satisfy a row value comparison with a single index range scan. Oracle
+		// only supports row value comparisons for equality.
+		if (same_direction && _opts.database != "oracle") {
+			_state.values.insert(std::end(_state.values), std::begin(keyset.values), std::end(keyset.values));
+
+			return fmt::format("({}) {} ({})",
+			                   fmt::join(columns, ", "),
+			                   op(sort_expressions.front()),
+			                   fmt::join(std::vector<std::string_view>(columns.size(), "?"), ", "));
+		}
+
+		// Equivalent to the row value comparison, e.g. (a > ?) or (a = ? and b < ?).
+		std::vector<std::string> terms;
+		terms.reserve(columns.size());
+
+		for (std::size_t i = 0; i < columns.size(); ++i) {
+			std::vector<std::string> parts;
+
+			for (std::size_t j = 0; j < i; ++j) {
+				parts.push_back(fmt::format("{} = ?", columns[j]));
+				_state.values.push_back(keyset.values[j]);
 			}
+
+			parts.push_back(fmt::format("{} {} ?", columns[i], op(sort_expressions[i])));
+			_state.values.push_back(keyset.values[i]);
+
+			terms.push_back(fmt::format("({})", fmt::join(parts, " and ")));
 		}
 
-		// All columns in the order by clause must exist in the list of columns to project.
-		return fmt::format(" order by {}", fmt::join(sort_expr, ", "));
-	} // generate_order_by_clause
+		return fmt::format("({})", fmt::join(terms, " or "));
+	} // generate_keyset_predicate
 
 	auto generate_with_clause_for_data_resc_hier(const gq_state& _state, const std::string_view _database)
 		-> std::string
@@ -737,9 +878,254 @@ namespace
 		                   fmt::arg("char_type", "varchar"));
 	} // generate_with_clause_for_data_resc_hier
 
+	// Implements the LIKE operator of PostgreSQL, where a backslash escapes the character
+	// following it. Returns an empty optional if the pattern is rejected by the database or
+	// cannot be matched byte by byte.
+	auto like_matches(std::string_view _value, std::string_view _pattern) -> std::optional<bool>
+	{
+		enum class token_kind
+		{
+			literal,
+			any_character,
+			any_sequence
+		};
+
+		struct token
+		{
+			token_kind kind;
+			char c;
+		};
+
+		std::vector<token> tokens;
+		tokens.reserve(_pattern.size());
+
+		for (std::string_view::size_type i = 0; i < _pattern.size(); ++i) {
+			if ('\\' == _pattern[i]) {
+				if (++i == _pattern.size()) {
+					return std::nullopt;
+				}
+
+				tokens.push_back({token_kind::literal, _pattern[i]});
+			}
+			else if ('%' == _pattern[i]) {
+				tokens.push_back({token_kind::any_sequence, '\0'});
+			}
+			else if ('_' == _pattern[i]) {
+				// "_" matches one character, which is not one byte for non-ASCII characters.
+				const auto is_ascii = [](char _c) { return static_cast<unsigned char>(_c) < 0x80; };
+
+				if (!std::all_of(std::begin(_value), std::end(_value), is_ascii)) {
+					return std::nullopt;
+				}
+
+				tokens.push_back({token_kind::any_character, '\0'});
+			}
+			else {
+				tokens.push_back({token_kind::literal, _pattern[i]});
+			}
+		}
+
+		constexpr auto npos = std::vector<token>::size_type(-1);
+
+		std::string_view::size_type v = 0;
+		std::vector<token>::size_type t = 0;
+
+		// The position of the last "%" and of the value when it was reached. On a mismatch, the
+		// "%" is retried with one more character.
+		auto sequence_token = npos;
+		std::string_view::size_type sequence_value = 0;
+
+		while (v < _value.size()) {
+			if (t < tokens.size() && (token_kind::any_character == tokens[t].kind ||
+			                          (token_kind::literal == tokens[t].kind && tokens[t].c == _value[v])))
+			{
+				++v;
+				++t;
+			}
+			else if (t < tokens.size() && token_kind::any_sequence == tokens[t].kind) {
+				sequence_token = t++;
+				sequence_value = v;
+			}
+			else if (sequence_token != npos) {
+				t = sequence_token + 1;
+				v = ++sequence_value;
+			}
+			else {
+				return false;
+			}
+		}
+
+		while (t < tokens.size() && token_kind::any_sequence == tokens[t].kind) {
+			++t;
+		}
+
+		return t == tokens.size();
+	} // like_matches
+
+	// Evaluates a condition on DATA_RESC_HIER against the hierarchy of one resource. Returns an
+	// empty optional if the result may differ from the database's. Hierarchies are never null.
+	class hierarchy_condition_evaluator
+	{
+	  public:
+		explicit hierarchy_condition_evaluator(std::string_view _hierarchy)
+			: hierarchy_{_hierarchy}
+		{
+		}
+
+		auto operator()(const gq::condition_equal& _equal) const -> std::optional<bool>
+		{
+			return hierarchy_ == _equal.string_literal;
+		}
+
+		auto operator()(const gq::condition_not_equal& _not_equal) const -> std::optional<bool>
+		{
+			return hierarchy_ != _not_equal.string_literal;
+		}
+
+		auto operator()(const gq::condition_in& _in) const -> std::optional<bool>
+		{
+			return contains(_in.list_of_string_literals, hierarchy_);
+		}
+
+		auto operator()(const gq::condition_like& _like) const -> std::optional<bool>
+		{
+			return like_matches(hierarchy_, _like.string_literal);
+		}
+
+		auto operator()(const gq::condition_is_null&) const -> std::optional<bool>
+		{
+			return false;
+		}
+
+		auto operator()(const gq::condition_is_not_null&) const -> std::optional<bool>
+		{
+			return true;
+		}
+
+		// The ordering of strings depends on the collation of the database.
+		template <typename T>
+		auto operator()(const T&) const -> std::optional<bool>
+		{
+			return std::nullopt;
+		}
+
+	  private:
+		std::string_view hierarchy_;
+	}; // class hierarchy_condition_evaluator
+
+	// Resolves each condition on DATA_RESC_HIER within _conditions to the resources matching it,
+	// appending the results to _resolved in the order the conditions are visited when generating
+	// SQL. Returns false if any of the conditions cannot be resolved.
+	//
+	// Conditions are only resolved for PostgreSQL. The comparisons of the other databases depend
+	// on their collation (MySQL) or treat empty strings as null (Oracle).
+	auto resolve_hierarchy_conditions(const gq::conditions& _conditions,
+	                                  const gq::options& _opts,
+	                                  std::vector<resolved_hierarchy_condition>& _resolved) -> bool
+	{
+		// Keeps the SQL within the limits of the databases on the number of bindable values.
+		constexpr std::size_t max_resolved_resources = 1000;
+
+		// The leaves of the tree appear in the order they are visited when generating SQL.
+		for (auto&& ct : _conditions) {
+			const auto* condition = std::get_if<gq::condition>(&ct);
+
+			if (!condition || condition->column.name != "DATA_RESC_HIER") {
+				continue;
+			}
+
+			if (_opts.database != "postgres" || !condition->column.type_name.empty()) {
+				return false;
+			}
+
+			std::vector<std::string> matches;
+			std::vector<std::string> non_matches;
+
+			for (auto&& [resc_id, hierarchy] : *_opts.resource_hierarchies) {
+				const auto result = std::visit(hierarchy_condition_evaluator{hierarchy}, condition->expression);
+
+				if (!result) {
+					return false;
+				}
+
+				(*result != condition->negated ? matches : non_matches).push_back(resc_id);
+			}
+
+			auto& r = _resolved.emplace_back();
+			r.negated = non_matches.size() < matches.size();
+			r.resc_ids = std::move(r.negated ? non_matches : matches);
+
+			if (r.resc_ids.size() > max_resolved_resources) {
+				return false;
+			}
+
+			// Keeps the SQL identical across agents whose maps iterate in a different order.
+			std::sort(std::begin(r.resc_ids), std::end(r.resc_ids));
+		}
+
+		return true;
+	} // resolve_hierarchy_conditions
+
+	// Returns true if DATA_RESC_HIER can be resolved via the resource hierarchies found in
+	// _opts. The recursive WITH clause is still required when the database must sort, group, or
+	// aggregate the hierarchies.
+	auto resolve_resource_hierarchies_in_memory(const gq::select& _select,
+	                                            const gq::options& _opts,
+	                                            std::vector<resolved_hierarchy_condition>& _resolved) -> bool
+	{
+		if (!_opts.resource_hierarchies) {
+			return false;
+		}
+
+		constexpr std::string_view column_name = "DATA_RESC_HIER";
+
+		for (auto&& s : _select.selections) {
+			if (const auto* column = std::get_if<gq::column>(&s); column) {
+				if (column->name == column_name && !column->type_name.empty()) {
+					return false;
+				}
+			}
+			else if (std::get<gq::select_function>(s).column.name == column_name) {
+				return false;
+			}
+		}
+
+		const auto& sort_expressions = _select.order_by.sort_expressions;
+		const auto sorts_by_hierarchy =
+			std::any_of(std::begin(sort_expressions), std::end(sort_expressions), [column_name](auto&& _se) {
+				return _se.column == column_name;
+			});
+
+		if (sorts_by_hierarchy || contains(_select.group_by.columns, column_name) ||
+		    contains(_select.keyset.columns, column_name))
+		{
+			return false;
+		}
+
+		return resolve_hierarchy_conditions(_select.conditions, _opts, _resolved);
+	} // resolve_resource_hierarchies_in_memory
+
 	auto generate_limit_clause(const irods::experimental::api::genquery::options& _opts,
-	                           const std::string_view _number_of_rows) -> std::string
+	                           const std::string_view _number_of_rows,
+	                           const std::string_view _offset) -> std::string
 	{
+		if (_opts.max_number_of_rows > 0) {
+			auto n = _opts.max_number_of_rows;
+
+			if (!_number_of_rows.empty()) {
+				n = std::min<std::uint64_t>(n, std::stoull(std::string{_number_of_rows}));
+			}
+			else if (_opts.default_number_of_rows > 0) {
+				n = std::min<std::uint64_t>(n, _opts.default_number_of_rows);
+			}
+
+			if (_opts.database == "mysql") {
+				return fmt::format(" limit {}", n);
+			}
+
+			return fmt::format(" fetch first {} rows only", n);
+		}
+
 		if (!_number_of_rows.empty()) {
 			if (_opts.database == "mysql") {
 				return fmt::format(" limit {}", _number_of_rows);
@@ -748,6 +1134,18 @@ namespace
 			return fmt::format(" fetch first {} rows only", _number_of_rows);
 		}
 
+		if (0 == _opts.default_number_of_rows) {
+			// MySQL does not support OFFSET without LIMIT. The documentation recommends using the
+			// largest unsigned 64-bit integer as the number of rows to retrieve.
+			//
+			// See https://dev.mysql.com/doc/refman/8.0/en/select.html.
+			if (_opts.database == "mysql" && !_offset.empty()) {
+				return " limit 18446744073709551615";
+			}
+
+			return {};
+		}
+
 		if (_opts.database == "mysql") {
 			return fmt::format(" limit {}", _opts.default_number_of_rows);
 		}
@@ -822,8 +1220,13 @@ namespace irods::experimental::api::genquery
 			}
 		}
 		else if (_column.name == "DATA_RESC_HIER") {
-			add_r_resc_main = _state.add_sql_for_data_resc_hier = true;
-			table_alias = "cte_drh";
+			add_r_resc_main = true;
+
+			// Otherwise, the column is resolved to the resource ID. See to_sql(column).
+			if (!_state.resource_hierarchies) {
+				_state.add_sql_for_data_resc_hier = true;
+				table_alias = "cte_drh";
+			}
 		}
 		else {
 			is_special_column = false;
@@ -861,7 +1264,7 @@ namespace irods::experimental::api::genquery
 			}
 			else {
 				_state.sql_tables.push_back(_column_info.table);
-				_state.table_aliases[std::string{_column_info.table}] = generate_table_alias(_state);
+				_state.table_aliases[_column_info.table] = generate_table_alias(_state);
 			}
 		}
 
@@ -881,19 +1284,19 @@ namespace irods::experimental::api::genquery
 		_state.ast_column_ptrs.push_back(&_column);
 
 		auto [is_special_column, table_alias] = setup_column_for_post_processing(_state, _column, iter->second);
-		auto* columns_ptr =
-			_state.in_select_clause ? &_state.columns_for_select_clause : &_state.columns_for_where_clause;
-		const std::string_view alias =
-			is_special_column ? table_alias : _state.table_aliases.at(std::string{iter->second.table});
 
-		if (_column.type_name.empty()) {
-			columns_ptr->push_back(fmt::format("{}.{}", alias, iter->second.name));
+		// The caller replaces the resource ID with its hierarchy.
+		if (_state.resource_hierarchies && _column.name == "DATA_RESC_HIER") {
+			return fmt::format("{}.resc_id", _state.table_aliases.at("R_RESC_MAIN"));
 		}
-		else {
-			columns_ptr->push_back(fmt::format("cast({}.{} as {})", alias, iter->second.name, _column.type_name));
+
+		const std::string_view alias = is_special_column ? table_alias : _state.table_aliases.at(iter->second.table);
+
+		if (_column.type_name.empty()) {
+			return fmt::format("{}.{}", alias, iter->second.name);
 		}
 
-		return columns_ptr->back();
+		return fmt::format("cast({}.{} as {})", alias, iter->second.name, _column.type_name);
 	}
 
 	auto to_sql(gq_state& _state, const select_function& _select_function) -> std::string
@@ -915,25 +1318,22 @@ namespace irods::experimental::api::genquery
 
 		auto [is_special_column, table_alias] =
 			setup_column_for_post_processing(_state, _select_function.column, iter->second);
-		auto* columns_ptr = &_state.columns_for_select_clause;
-		const std::string_view alias =
-			is_special_column ? table_alias : _state.table_aliases.at(std::string{iter->second.table});
+		const std::string_view alias = is_special_column ? table_alias : _state.table_aliases.at(iter->second.table);
 
 		if (_select_function.column.type_name.empty()) {
-			columns_ptr->push_back(fmt::format("{}({}.{})", _select_function.name, alias, iter->second.name));
-		}
-		else {
-			columns_ptr->push_back(fmt::format("{}(cast({}.{} as {}))",
-			                                   _select_function.name,
-			                                   alias,
-			                                   iter->second.name,
-			                                   _select_function.column.type_name));
+			return fmt::format("{}({}.{})", _select_function.name, alias, iter->second.name);
 		}
 
-		return columns_ptr->back();
+		return fmt::format("{}(cast({}.{} as {}))",
+		                   _select_function.name,
+		                   alias,
+		                   iter->second.name,
+		                   _select_function.column.type_name);
 	}
 
-	auto to_sql(gq_state& _state, const selections& _selections) -> std::string
+	// _alias_columns gives every column a unique name (i.e. c0, c1, ...). A derived table must
+	// not contain duplicate column names (e.g. "select COLL_NAME, COLL_NAME") on every database.
+	auto to_sql(gq_state& _state, const selections& _selections, bool _alias_columns) -> std::string
 	{
 		irods::at_scope_exit restore_value{[&_state] { _state.in_select_clause = false; }};
 
@@ -949,19 +1349,28 @@ namespace irods::experimental::api::genquery
 			throw std::runtime_error{"no columns selected"};
 		}
 
-		std::vector<std::string> cols;
+		std::string cols;
 		sql_visitor v{_state};
 
-		for (auto&& s : _selections) {
-			cols.push_back(boost::apply_visitor(v, s));
-		}
+		for (std::size_t i = 0; i < _selections.size(); ++i) {
+			const auto& s = _selections[i];
 
-		return fmt::format("{}", fmt::join(cols, ", "));
-	}
+			if (i > 0) {
+				cols += ", ";
+			}
 
-	auto to_sql(gq_state& _state, const condition_operator_not& _op_not) -> std::string
-	{
-		return fmt::format(" not{}", boost::apply_visitor(sql_visitor{_state}, _op_not.expression));
+			cols += std::visit(v, s);
+
+			if (_alias_columns) {
+				cols += fmt::format(" c{}", i);
+			}
+
+			if (const auto* c = std::get_if<column>(&s); _state.resource_hierarchies && c && c->name == "DATA_RESC_HIER") {
+				_state.resource_hierarchy_positions.push_back(i);
+			}
+		}
+
+		return cols;
 	}
 
 	auto to_sql(gq_state& _state, const condition_not_equal& _not_equal) -> std::string
@@ -1047,61 +1456,120 @@ namespace irods::experimental::api::genquery
 
 	auto to_sql(gq_state& _state, const condition& _condition) -> std::string
 	{
-		return fmt::format("{}{}",
+		if (_state.resource_hierarchies && _condition.column.name == "DATA_RESC_HIER") {
+			const auto column = to_sql(_state, _condition.column);
+			const auto& resolved =
+				_state.resolved_hierarchy_conditions.at(_state.next_resolved_hierarchy_condition++);
+
+			if (resolved.resc_ids.empty()) {
+				return resolved.negated ? "1 = 1" : "1 = 0";
+			}
+
+			return fmt::format(
+				"{}{}{}", column, resolved.negated ? " not" : "", to_sql(_state, condition_in{resolved.resc_ids}));
+		}
+
+		return fmt::format("{}{}{}",
 		                   to_sql(_state, _condition.column),
-		                   boost::apply_visitor(sql_visitor{_state}, _condition.expression));
+		                   _condition.negated ? " not" : "",
+		                   std::visit(sql_visitor{_state}, _condition.expression));
 	}
 
 	auto to_sql(gq_state& _state, const conditions& _conditions) -> std::string
 	{
 		std::string ret;
 
-		for (auto&& condition : _conditions) {
-			ret += boost::apply_visitor(sql_visitor{_state}, condition);
+		if (_conditions.empty()) {
+			return ret;
 		}
 
-		return ret;
-	}
-
-	auto to_sql(gq_state& _state, const logical_and& _condition) -> std::string
-	{
-		return fmt::format(" and {}", to_sql(_state, _condition.condition));
-	}
+		// Either a node to expand or, if "node" is empty, text to append.
+		struct work_item
+		{
+			std::optional<node_index> node;
+			std::string_view text;
+		}; // struct work_item
+
+		// The tree is walked depth-first starting at the root (i.e. the last node). Operands are
+		// pushed in reverse so that they are expanded in the order they were written.
+		std::pmr::vector<work_item> stack{_state.arena};
+		stack.push_back({static_cast<node_index>(_conditions.size() - 1), {}});
+
+		while (!stack.empty()) {
+			const auto item = stack.back();
+			stack.pop_back();
+
+			if (!item.node) {
+				ret += item.text;
+				continue;
+			}
 
-	auto to_sql(gq_state& _state, const logical_or& _condition) -> std::string
-	{
-		return fmt::format(" or {}", to_sql(_state, _condition.condition));
-	}
+			const auto& node = _conditions[*item.node];
 
-	auto to_sql(gq_state& _state, const logical_not& _condition) -> std::string
-	{
-		return fmt::format("not {}", to_sql(_state, _condition.condition));
-	}
+			if (const auto* op_and = std::get_if<logical_and>(&node); op_and) {
+				stack.push_back({op_and->rhs, {}});
+				stack.push_back({std::nullopt, " and "});
+				stack.push_back({op_and->lhs, {}});
+			}
+			else if (const auto* op_or = std::get_if<logical_or>(&node); op_or) {
+				stack.push_back({op_or->rhs, {}});
+				stack.push_back({std::nullopt, " or "});
+				stack.push_back({op_or->lhs, {}});
+			}
+			else if (const auto* op_not = std::get_if<logical_not>(&node); op_not) {
+				ret += "not ";
+				stack.push_back({op_not->condition, {}});
+			}
+			else if (const auto* grouping = std::get_if<logical_grouping>(&node); grouping) {
+				ret += '(';
+				stack.push_back({std::nullopt, ")"});
+				stack.push_back({grouping->conditions, {}});
+			}
+			else {
+				ret += to_sql(_state, std::get<condition>(node));
+			}
+		}
 
-	auto to_sql(gq_state& _state, const logical_grouping& _condition) -> std::string
-	{
-		return fmt::format("({})", to_sql(_state, _condition.conditions));
+		return ret;
 	}
 
-	auto to_sql(const select& _select, const options& _opts) -> std::tuple<std::string, std::vector<std::string>>
+	auto to_sql(const select& _select, const options& _opts)
+		-> std::tuple<std::string, std::vector<std::string>, std::vector<std::size_t>, std::vector<std::size_t>>
 	{
 		try {
 			log_gq::set_level(irods::experimental::log::get_level_from_config("genquery2"));
 
-			gq_state state;
+			// Scratch memory for the translation. Most queries are translated without leaving the
+			// buffer on the stack.
+			std::array<std::byte, 4096> buffer;
+			std::pmr::monotonic_buffer_resource arena{buffer.data(), buffer.size()};
+
+			gq_state state{&arena};
+
+			if (resolve_resource_hierarchies_in_memory(_select, _opts, state.resolved_hierarchy_conditions)) {
+				state.resource_hierarchies = _opts.resource_hierarchies;
+			}
 
 			log_gq::trace("### PHASE 1: Gather");
 
-			const auto cols = to_sql(state, _select.selections);
+			// When counting, the query becomes a derived table.
+			const auto cols = to_sql(state, _select.selections, _opts.count_only);
 			log_gq::debug("SELECT COLUMNS = {}", cols);
 
 			// Convert the conditions of the general query statement into SQL with prepared
 			// statement placeholders.
-			const auto conds = to_sql(state, _select.conditions);
+			auto conds = to_sql(state, _select.conditions);
+
+			// The keyset predicate is generated here so that its bindable values follow the values
+			// of the conditions.
+			if (const auto seek = generate_keyset_predicate(state, _opts, _select, column_name_mappings); !seek.empty()) {
+				conds = conds.empty() ? seek : fmt::format("({}) and {}", conds, seek);
+			}
+
 			log_gq::debug("CONDITIONS = {}", conds);
 
 			if (state.sql_tables.empty()) {
-				return {{}, {}};
+				return {{}, {}, {}, {}};
 			}
 
 			{
@@ -1113,7 +1581,7 @@ namespace irods::experimental::api::genquery
 			std::for_each(std::begin(state.sql_tables), std::end(state.sql_tables), [&state](auto&& _t) {
 				std::string_view alias = "";
 
-				if (const auto iter = state.table_aliases.find(std::string{_t}); iter != std::end(state.table_aliases))
+				if (const auto iter = state.table_aliases.find(_t); iter != std::end(state.table_aliases))
 				{
 					alias = iter->second;
 				}
@@ -1126,6 +1594,7 @@ namespace irods::experimental::api::genquery
 			log_gq::debug("Requires metadata table joins for R_RESC_MAIN? {}", state.add_joins_for_meta_resc);
 			log_gq::debug("Requires metadata table joins for R_USER_MAIN? {}", state.add_joins_for_meta_user);
 			log_gq::debug("Requires table joins for DATA_RESC_HIER? {}", state.add_sql_for_data_resc_hier);
+			log_gq::debug("Resolves DATA_RESC_HIER in memory? {}", state.resource_hierarchies != nullptr);
 
 			//
 			// Generate SQL
@@ -1133,7 +1602,8 @@ namespace irods::experimental::api::genquery
 
 			log_gq::trace("### PHASE 2: SQL Generation");
 
-			auto graph = init_graph();
+			// The graph never changes, so it is built once.
+			static const auto graph = init_graph();
 
 			// Generate the SELECT clause.
 			//
@@ -1143,19 +1613,17 @@ namespace irods::experimental::api::genquery
 			//
 			// The tables stored in sql_tables must be directly joinable to at least one other table in
 			// the sql_tables list. This step is NOT allowed to introduce intermediate tables.
+			const auto with_clause = generate_with_clause_for_data_resc_hier(state, _opts.database);
+
+			// When counting, the WITH clause is placed in front of the statement which wraps the
+			// query. Not every database allows it within a derived table.
 			auto select_clause =
 				fmt::format("{with_clause}select {distinct}{columns} from {table} {alias}",
-			                fmt::arg("with_clause", generate_with_clause_for_data_resc_hier(state, _opts.database)),
+			                fmt::arg("with_clause", _opts.count_only ? "" : with_clause),
 			                fmt::arg("distinct", _select.distinct ? "distinct " : ""),
-			                ///////////////////
-			                // TODO The next two lines produce the same result and the "state.columns_for_*" members
-			                // aren't used for anything else outside of this line. Therefore, we can probably get rid
-			                // of those vectors.
-			                //fmt::arg("columns", fmt::join(state.columns_for_select_clause, ", ")),
 			                fmt::arg("columns", cols),
 			                fmt::arg("table", state.sql_tables.front()),
-			                ///////////////////
-			                fmt::arg("alias", state.table_aliases.at(std::string{state.sql_tables.front()})));
+			                fmt::arg("alias", state.table_aliases.at(state.sql_tables.front())));
 
 			log_gq::debug("SELECT CLAUSE => {}", select_clause);
 
@@ -1169,7 +1637,10 @@ namespace irods::experimental::api::genquery
 				throw std::invalid_argument{"invalid general query"};
 			}
 
-			auto sql = select_clause;
+			// The joins and the remaining clauses are appended below. Reserving room for them up front
+			// keeps the string from being reallocated for each one.
+			auto sql = std::move(select_clause);
+			sql.reserve(sql.size() + 1024);
 
 			if (!inner_joins.empty()) {
 				sql += fmt::format(" {}", fmt::join(inner_joins, " "));
@@ -1190,8 +1661,17 @@ namespace irods::experimental::api::genquery
 
 			sql += generate_condition_clause(state, _opts, conds);
 			sql += generate_group_by_clause(state, _select.group_by, column_name_mappings);
+
+			// The rows of the query are counted as a whole. Sorting them would be wasted work and
+			// limiting them would change the count.
+			if (_opts.count_only) {
+				sql = fmt::format("{}select count(*) from ({}) cnt", with_clause, sql);
+				log_gq::debug("GENERATED SQL => [{}]", sql);
+				return {sql, std::move(state.values), std::move(state.username_value_positions), {}};
+			}
+
 			sql += generate_order_by_clause(state, _select.order_by, column_name_mappings);
-			sql += generate_limit_clause(_opts, _select.range.number_of_rows);
+			sql += generate_limit_clause(_opts, _select.range.number_of_rows, _select.range.offset);
 
 			// MySQL requires that the OFFSET clause be defined after the LIMIT clause, therefore we
 			// handle OFFSET here.
@@ -1207,12 +1687,20 @@ namespace irods::experimental::api::genquery
 
 			log_gq::debug("GENERATED SQL => [{}]", sql);
 
-			return {sql, std::move(state.values)};
+			return {sql,
+			        std::move(state.values),
+			        std::move(state.username_value_positions),
+			        std::move(state.resource_hierarchy_positions)};
 		}
 		catch (const std::exception& e) {
 			log_gq::error(e.what());
 		}
 
-		return {{}, {}};
+		return {{}, {}, {}, {}};
 	} // to_sql
+
+	auto is_catalog_table(std::string_view _table_name) noexcept -> bool
+	{
+		return std::find(std::begin(table_names), std::end(table_names), _table_name) != std::end(table_names);
+	} // is_catalog_table
 } // namespace irods::experimental::api::genquery
@@ -236,12 +236,53 @@ namespace
 		return SUCCESS();
 	} // genquery2_destroy
 
+	auto genquery2_invalidate_cache(std::list<boost::any>& _rule_arguments, irods::callback& _effect_handler)
+		-> irods::error
+	{
+		log_re::trace(__func__);
+
+		if (_rule_arguments.size() != 1) {
+			const auto msg =
+				fmt::format("Incorrect number of input arguments: expected 1, received {}", _rule_arguments.size());
+			log_re::error(msg);
+			return ERROR(SYS_INVALID_INPUT_PARAM, msg);
+		}
+
+		try {
+			auto& rei = get_rei(_effect_handler);
+			auto* tables = boost::any_cast<std::string*>(*std::begin(_rule_arguments));
+
+			genquery2_input input{};
+			input.invalidate_tables = tables->data();
+
+			char* results{};
+			irods::at_scope_exit free_results{[&results] { std::free(results); }};
+
+			if (const auto ec = irods::server_api_call(IRODS_APN_GENQUERY2, rei.rsComm, &input, &results); ec != 0) {
+				const auto msg = fmt::format("Error while invalidating GenQuery2 result cache [error_code=[{}]].", ec);
+				log_re::error(msg);
+				return ERROR(ec, msg);
+			}
+
+			return SUCCESS();
+		}
+		catch (const irods::exception& e) {
+			log_re::error(e.client_display_what());
+			return ERROR(e.code(), e.client_display_what());
+		}
+		catch (const std::exception& e) {
+			log_re::error(e.what());
+			return ERROR(SYS_LIBRARY_ERROR, e.what());
+		}
+	} // genquery2_invalidate_cache
+
 	// clang-format off
 	const std::map<std::string_view, handler_type> handlers{
 		{"genquery2_execute", genquery2_execute},
 		{"genquery2_next_row", genquery2_next_row},
 		{"genquery2_column", genquery2_column},
-		{"genquery2_destroy", genquery2_destroy}
+		{"genquery2_destroy", genquery2_destroy},
+		{"genquery2_invalidate_cache", genquery2_invalidate_cache}
 	};
 	// clang-format on
 
@@ -355,6 +396,8 @@ namespace
 				}
 				else if (op == "genquery2_destroy") {
 				}
+				else if (op == "genquery2_invalidate_cache") {
+				}
 
 				return (iter->second)(args, _effect_handler);
 			}